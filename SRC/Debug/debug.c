@@ -1,36 +1,25 @@
 #include <debug.h>
 
 void delay (int time) {
-
-    SysTick->SR &= ~(1 << 0);
-    SysTick->CMP = 1000 - 1;
-    SysTick->CNT = 0;
-    SysTick->CTLR = 0xb;
-
-    volatile uint64_t now = millisec;
-    volatile uint64_t stop = now + (uint64_t)time;
-    while (millisec <= stop) { 
+    uint32_t start = now_ms();
+    while (elapsed_ms (start) <= (uint32_t)time) {
         __NOP();
     }
 }
 
-static uint8_t  p_us = 0;
-static uint16_t p_ms = 0;
-
 #define DEBUG_DATA0_ADDRESS  ((volatile uint32_t*)0xE00000F4)
 #define DEBUG_DATA1_ADDRESS  ((volatile uint32_t*)0xE00000F8)
 
 /*********************************************************************
  * @fn      Delay_Init
  *
- * @brief   Initializes Delay Funcation.
+ * @brief   Initializes Delay Funcation (starts the free-running SysTick).
  *
  * @return  none
  */
 void Delay_Init(void)
 {
-    p_us = SystemCoreClock / 8000000;
-    p_ms = (uint16_t)p_us * 1000;
+    SysTime_Init();
 }
 
 /*********************************************************************
@@ -44,17 +33,9 @@ void Delay_Init(void)
  */
 void Delay_Us(uint32_t n)
 {
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_us;
+    uint32_t start = now_us();
 
-    SysTick->CMP = i;
-    SysTick->CNT = 0;
-    SysTick->CTLR |=(1 << 0);
-
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    while(elapsed_us(start) < n);
 }
 
 /*********************************************************************
@@ -68,17 +49,10 @@ void Delay_Us(uint32_t n)
  */
 void Delay_Ms(uint32_t n)
 {
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_ms;
-
-    SysTick->CMP = i;
-    SysTick->CNT = 0;
-    SysTick->CTLR |=(1 << 0);
-
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    while(n--)
+    {
+        Delay_Us(1000);
+    }
 }
 
 /*********************************************************************
@@ -92,6 +66,9 @@ void Delay_Ms(uint32_t n)
  */
 void USART_Printf_Init(uint32_t baudrate)
 {
+#if (DEBUG == DEBUG_NONE)
+    (void)baudrate;  // Вывод отключён (debug.h): PD6 остаётся входом
+#else
     GPIO_InitTypeDef  GPIO_InitStructure;
     USART_InitTypeDef USART_InitStructure;
 
@@ -141,6 +118,7 @@ void USART_Printf_Init(uint32_t baudrate)
 
     USART_Init(USART1, &USART_InitStructure);
     USART_Cmd(USART1, ENABLE);
+#endif
 }
 
 /*********************************************************************
@@ -207,6 +185,10 @@ int _write(int fd, char *buf, int size)
 
     } while (writeSize);
 
+#elif (DEBUG == DEBUG_NONE)
+    (void)i;
+    (void)buf;
+
 #else
 
     for(i = 0; i < size; i++){
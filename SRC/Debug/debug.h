@@ -11,17 +11,34 @@ extern "C" {
 
 
 #include "buzzer_tunes.h"
+#include "systime.h"
+
+/* Вход шунта тока (current.c), значение = канал АЦП */
+#define CURRENT_PA1 1  // AIN1. SOP-8 (J4M6): вывод 1, общий с PD6 (TX printf)
+#define CURRENT_PD2 3  // AIN3. TSSOP-20 / QFN-20: отдельный вывод
+
+#ifndef CURRENT_PIN
+#define CURRENT_PIN CURRENT_PA1
+#endif
 
 /* UART Printf Definition */
+#define DEBUG_NONE 0           // UART не используется, printf никуда не выводит
 #define DEBUG_UART1_NoRemap 1  // Tx-PD5
 #define DEBUG_UART1_Remap1 2   // Tx-PD0
 #define DEBUG_UART1_Remap2 3   // Tx-PD6
 #define DEBUG_UART1_Remap3 4   // Tx-PC0
 
 /* DEBUG UATR Definition */
+// Шунт на PA1: на SOP-8 передача по TX (PD6) попадает прямо в измерение
+// тока, и сторож АЦП срабатывает от трафика UART - вывод отключается.
+// Отладочный printf - с шунтом на CURRENT_PD2 (корпус с 20 выводами)
 #ifndef DEBUG
+#if CURRENT_PIN == CURRENT_PA1
+#define DEBUG DEBUG_NONE
+#else
 #define DEBUG DEBUG_UART1_Remap2  // DEBUG_UART1_Remap2
 #endif
+#endif
 
 /* SDI Printf Definition */
 #define SDI_PR_CLOSE 0
@@ -34,9 +51,6 @@ extern "C" {
 #define LED_ON GPIO_WriteBit (GPIOC, GPIO_Pin_2, Bit_SET)
 #define LED_OFF GPIO_WriteBit (GPIOC, GPIO_Pin_2, Bit_RESET)
 
-#define BUZZER_ON GPIO_WriteBit (GPIOC, GPIO_Pin_1, Bit_SET)
-#define BUZZER_OFF GPIO_WriteBit (GPIOC, GPIO_Pin_1, Bit_RESET)
-
 #define KEY GPIO_ReadInputDataBit (GPIOC, GPIO_Pin_4)
 
 void Delay_Init (void);
@@ -54,8 +68,6 @@ enum Screen {
     SET_BOOST_TIME,    // 4
 };
 
-extern uint64_t millisec;
-
 // main.c
 extern uint16_t comandMotorOn;       // Признак того что мотор должен работать
 
@@ -66,6 +78,7 @@ extern uint16_t configCurrentPower;  // Текущая мощность 0..100
 extern void gotoDeepSleep (void);
 
 extern void delay (int time);
+extern void userEEPROMSave (void);  // Все настройки одним пакетом
 
 // init.c
 extern void init (void);
@@ -89,9 +102,89 @@ extern void ScreenBoostTime (void);
 //motor.cpp
 extern void Motor_Start(void);
 extern void Motor_Stop(void);
-extern void Motor_Tick(void);
+extern void Motor_Tick(void);       // Из SysTick_Handler, 1 кГц
 extern void Motor_Toggle();
 extern int  Motor_isStop(void);
+extern int  Motor_isFault(void);
+extern uint16_t Motor_GetRpm(void);   // Тахо или пульсации тока, 0 - не RUNNING
+extern void Motor_Play(const uint16_t *tab, uint16_t len, uint8_t hold, uint8_t loop);
+
+//current.c
+extern void     Current_Init(void);
+extern uint16_t Current_Get(void);  // Среднее, сырые единицы АЦП 0..1023
+extern uint16_t Current_Last(void); // Последний отсчёт
+extern uint16_t Current_Vref(void); // Отсчёт Vrefint (1.2 В), 0 - ещё нет
+extern uint8_t  Current_Next(uint16_t *sample);
+extern void     Current_SetLimit(uint16_t raw);
+extern void     Current_Trip(void);
+extern uint8_t  Current_IsFault(void);
+extern void     Current_ClearFault(void);
+
+//pi.c
+typedef struct {
+    uint16_t kp;     // Q15
+    uint16_t ki;     // Q15, за один шаг
+    int16_t slew;    // Макс. изменение выхода за шаг, Q15
+    int32_t integ;   // Интегратор, Q30
+    int16_t out;     // Последний выход, Q15
+} Pi_t;
+
+extern void    Pi_Reset(Pi_t *pi, int16_t out);
+extern int16_t Pi_Step(Pi_t *pi, int16_t sp, int16_t pv);
+
+//ramp.c
+#define RAMP_LINEAR 0
+#define RAMP_SCURVE 1
+#define RAMP_EXP    2
+
+typedef struct {
+    uint16_t from;     // CCR в начале
+    uint16_t to;       // CCR в конце
+    uint16_t ms;       // Прошло, мс
+    uint16_t time_ms;  // Длительность, мс
+    uint32_t k;        // 65536 / time_ms: шаг позиции в Q16 за 1 мс
+    uint8_t shape;     // RAMP_LINEAR / RAMP_SCURVE / RAMP_EXP
+} Ramp_t;
+
+extern void     Ramp_Start(Ramp_t *r, uint16_t from, uint16_t to, uint16_t time_ms, uint8_t shape);
+extern uint16_t Ramp_Step(Ramp_t *r);
+extern uint8_t  Ramp_Done(const Ramp_t *r);
+
+//config.c
+#define CFG_START ((uint32_t)0x08003C00)  // Последний 1 КБ флеша (Link.ld: FLASH 15K)
+
+extern void         Cfg_Init(void);
+extern uint8_t      Cfg_Read(uint8_t id, uint16_t *value);
+extern void         Cfg_Load(void (*put)(uint8_t id, uint16_t value));  // Все записи за один проход
+extern FLASH_Status Cfg_Write(uint8_t id, uint16_t value);
+extern void         Cfg_Stage(uint8_t id, uint16_t value);  // В пакет, запись - Cfg_Flush
+extern FLASH_Status Cfg_Flush(void);
+
+//wave.c
+#define WAVE_PT(ccr) ((ccr) >> 1), (ccr)  // Точка таблицы: запуск АЦП, заполнение
+
+extern void    Wave_Play(const uint16_t *tab, uint16_t len, uint8_t hold, uint8_t loop);
+extern void    Wave_Stop(void);
+extern uint8_t Wave_IsDone(void);
+
+//tacho.c
+#define MOTOR_USE_TACHO 0  // 1 - на плате есть тахо/Холл на PD3 (TIM2_CH2)
+
+extern void     Tacho_Init(void);
+extern void     Tacho_Reset(void);
+extern void     Tacho_Capture(void);
+extern uint8_t  Tacho_Tick(void);  // 1 - новый период датчика
+extern uint8_t  Tacho_IsStalled(void);
+extern uint16_t Tacho_GetRpm(void);
+
+//ripple.c
+#define RIPPLE_RPM_MAX 10000  // Надёжный предел оценки (пульсация 1 кГц = fs / 5)
+#define RIPPLE_WINDOW_MS 100  // Окно счёта пиков: новое значение раз в окно
+#define RIPPLE_PER_REV 6      // Пульсаций тока на оборот ротора
+
+extern void     Ripple_Reset(void);
+extern uint8_t  Ripple_Tick(void);  // 1 - новое значение оборотов
+extern uint16_t Ripple_GetRpm(void);
 
 #ifdef __cplusplus
 }
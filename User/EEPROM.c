@@ -6,6 +6,7 @@
 
 #include "eeprom_ch32v.h"
 #include "ch32v00x_flash.h"
+#include <string.h>
 
 /* Helper to print page status */
 static const char* EE_StatusToString(uint16_t status) {
@@ -25,6 +26,38 @@ static uint32_t EE_FindValidPage(EEPROM_HandleTypeDef *heeprom);
 static uint16_t EE_GetVariablesCount(uint32_t pageBase, uint16_t skipAddress, uint32_t pageSize);
 static uint16_t EE_PageTransfer(EEPROM_HandleTypeDef *heeprom, uint32_t newPage, uint32_t oldPage, uint16_t skipAddress);
 static uint16_t EE_VerifyPageFullWriteVariable(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t Data);
+static void EE_IndexBuild(EEPROM_HandleTypeDef *heeprom);
+static uint16_t EE_ReadScan(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t *Data);
+
+/**
+  * @brief  Record tag: address in low byte, CRC-8 of address and data in high byte.
+  *         A write cut by power loss fails the CRC and is ignored instead of
+  *         turning into a bogus variable
+  */
+static uint16_t EE_Tag(uint16_t Address, uint16_t Data) {
+    uint8_t b[3] = {(uint8_t)Address, (uint8_t)Data, (uint8_t)(Data >> 8)};
+    uint8_t crc = 0xFF;
+    
+    for (uint8_t i = 0; i < 3; i++) {
+        crc ^= b[i];
+        for (uint8_t j = 0; j < 8; j++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return (uint16_t)(Address & 0xFF) | ((uint16_t)crc << 8);
+}
+
+/**
+  * @brief  Virtual address of the record whose tag is at tagAddr, 0xFFFF if none/corrupt
+  */
+static uint16_t EE_RecAddress(uint32_t tagAddr) {
+    uint16_t tag = (*(__IO uint16_t*)tagAddr);
+    
+    if (tag == 0xFFFF)
+        return 0xFFFF;
+    if (EE_Tag(tag & 0xFF, (*(__IO uint16_t*)(tagAddr - 2))) != tag)
+        return 0xFFFF;
+    return tag & 0xFF;
+}
 
 /**
   * @brief  Check page for blank
@@ -130,6 +163,37 @@ static uint32_t EE_FindValidPage(EEPROM_HandleTypeDef *heeprom) {
     return 0;
 }
 
+/**
+  * @brief  Build RAM index of the valid page (one forward pass)
+  */
+static void EE_IndexBuild(EEPROM_HandleTypeDef *heeprom) {
+    uint32_t pageBase = EE_FindValidPage(heeprom);
+    uint16_t slots = heeprom->PageSize / 4;
+    uint16_t s;
+
+    memset(heeprom->Index, 0, EEPROM_INDEX_SIZE);
+    heeprom->Spill = 0;
+    heeprom->Active = pageBase;
+    if (pageBase == 0)
+        return;
+
+    /* Later records overwrite earlier ones: the index ends up with the latest */
+    for (s = 1; s < slots; s++) {
+        uint32_t addr = pageBase + s * 4;
+        if ((*(__IO uint32_t*)addr) == 0xFFFFFFFF)
+            break;
+
+        uint16_t varAddress = EE_RecAddress(addr + 2);
+        if (varAddress < EEPROM_INDEX_SIZE)
+            heeprom->Index[varAddress] = s;
+        else if (varAddress != 0xFFFF && heeprom->Spill < 0xFF)
+            heeprom->Spill++;
+    }
+    heeprom->Free = s;
+
+    EEPROM_LOG("📇 Index @0x%08X free:%d spill:%d", (unsigned)pageBase, s, heeprom->Spill);
+}
+
 /**
   * @brief  Count unique variables in page
   */
@@ -141,14 +205,14 @@ static uint16_t EE_GetVariablesCount(uint32_t pageBase, uint16_t skipAddress, ui
     EEPROM_LOG("📊 Count @0x%08X", (unsigned)pageBase);
     
     for (uint32_t addr = pageBase + 6; addr < pageEnd; addr += 4) {
-        varAddress = (*(__IO uint16_t*)addr);
+        varAddress = EE_RecAddress(addr);
         if (varAddress == 0xFFFF || varAddress == skipAddress)
             continue;
         
         count++;
         
         for (uint32_t idx = addr + 4; idx < pageEnd; idx += 4) {
-            nextAddress = (*(__IO uint16_t*)idx);
+            nextAddress = EE_RecAddress(idx);
             if (nextAddress == varAddress) {
                 count--;
                 break;
@@ -191,14 +255,14 @@ static uint16_t EE_PageTransfer(EEPROM_HandleTypeDef *heeprom, uint32_t newPage,
     FLASH_Unlock();
     
     for (oldIdx = oldPage + (heeprom->PageSize - 2); oldIdx > oldEnd; oldIdx -= 4) {
-        address = (*(__IO uint16_t*)oldIdx);
+        address = EE_RecAddress(oldIdx);
         
         if (address == 0xFFFF || address == skipAddress)
             continue;
         
         found = false;
         for (uint32_t idx = newPage + 6; idx < newIdx; idx += 4) {
-            if ((*(__IO uint16_t*)idx) == address) {
+            if (EE_RecAddress(idx) == address) {
                 found = true;
                 break;
             }
@@ -217,7 +281,7 @@ static uint16_t EE_PageTransfer(EEPROM_HandleTypeDef *heeprom, uint32_t newPage,
                 return EEPROM_FLASH_ERROR;
             }
             
-            flashStatus = FLASH_ProgramHalfWord(newIdx + 2, address);
+            flashStatus = FLASH_ProgramHalfWord(newIdx + 2, EE_Tag(address, data));
             if (flashStatus != FLASH_COMPLETE) {
                 FLASH_Lock();
                 EEPROM_LOG("   ❌ Addr write err!");
@@ -261,50 +325,93 @@ static uint16_t EE_PageTransfer(EEPROM_HandleTypeDef *heeprom, uint32_t newPage,
     return EEPROM_OK;
 }
 
+/**
+  * @brief  Unique variables from RAM index, 0xFFFF if index does not cover page
+  */
+static uint16_t EE_IndexCount(EEPROM_HandleTypeDef *heeprom, uint16_t skipAddress) {
+    uint16_t count = 0;
+    
+    if (heeprom->Active == 0 || heeprom->Spill != 0)
+        return 0xFFFF;
+    
+    for (uint16_t a = 0; a < EEPROM_INDEX_SIZE; a++) {
+        if (heeprom->Index[a] != 0 && a != skipAddress)
+            count++;
+    }
+    return count;
+}
+
 /**
   * @brief  Write variable with page full check
   */
 static uint16_t EE_VerifyPageFullWriteVariable(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t Data) {
     FLASH_Status flashStatus;
     uint32_t pageBase, pageEnd, newPage;
+    uint32_t last = 0, freeIdx = 0;
     uint16_t count;
     
-    pageBase = EE_FindValidPage(heeprom);
+    pageBase = heeprom->Active ? heeprom->Active : EE_FindValidPage(heeprom);
     if (pageBase == 0)
         return EEPROM_NO_VALID_PAGE;
     
     pageEnd = pageBase + heeprom->PageSize;
     
-    for (uint32_t idx = pageEnd - 2; idx > pageBase; idx -= 4) {
-        if ((*(__IO uint16_t*)idx) == Address) {
-            count = (*(__IO uint16_t*)(idx - 2));
-            if (count == Data)
-                return EEPROM_OK;
-            if (count == 0xFFFF) {
-                FLASH_Unlock();
-                flashStatus = FLASH_ProgramHalfWord(idx - 2, Data);
-                FLASH_Lock();
-                return (flashStatus == FLASH_COMPLETE) ? EEPROM_OK : EEPROM_FLASH_ERROR;
+    /* Latest record of Address: from index, else scan backwards */
+    if (heeprom->Active && Address < EEPROM_INDEX_SIZE) {
+        if (heeprom->Index[Address])
+            last = pageBase + heeprom->Index[Address] * 4 + 2;
+    } else {
+        for (uint32_t idx = pageEnd - 2; idx > pageBase; idx -= 4) {
+            if (EE_RecAddress(idx) == Address) {
+                last = idx;
+                break;
             }
-            break;
         }
     }
     
-    for (uint32_t idx = pageBase + 4; idx < pageEnd; idx += 4) {
-        if ((*(__IO uint32_t*)idx) == 0xFFFFFFFF) {
-            FLASH_Unlock();
-            flashStatus = FLASH_ProgramHalfWord(idx, Data);
-            if (flashStatus != FLASH_COMPLETE) {
-                FLASH_Lock();
-                return EEPROM_FLASH_ERROR;
+    /* Same value - nothing to write. No in-place rewrite of 0xFFFF data:
+       the tag CRC covers the data */
+    if (last && (*(__IO uint16_t*)(last - 2)) == Data)
+        return EEPROM_OK;
+    
+    /* First erased slot: from index, else scan forwards */
+    if (heeprom->Active) {
+        if (heeprom->Free < heeprom->PageSize / 4)
+            freeIdx = pageBase + heeprom->Free * 4;
+    } else {
+        for (uint32_t idx = pageBase + 4; idx < pageEnd; idx += 4) {
+            if ((*(__IO uint32_t*)idx) == 0xFFFFFFFF) {
+                freeIdx = idx;
+                break;
             }
-            flashStatus = FLASH_ProgramHalfWord(idx + 2, Address);
+        }
+    }
+    
+    if (freeIdx) {
+        FLASH_Unlock();
+        flashStatus = FLASH_ProgramHalfWord(freeIdx, Data);
+        if (flashStatus != FLASH_COMPLETE) {
             FLASH_Lock();
-            return (flashStatus == FLASH_COMPLETE) ? EEPROM_OK : EEPROM_FLASH_ERROR;
+            heeprom->Active = 0;  // Slot state unknown - back to scanning
+            return EEPROM_FLASH_ERROR;
         }
+        flashStatus = FLASH_ProgramHalfWord(freeIdx + 2, EE_Tag(Address, Data));
+        FLASH_Lock();
+        
+        if (heeprom->Active) {
+            if (Address < EEPROM_INDEX_SIZE)
+                heeprom->Index[Address] = heeprom->Free;
+            else if (heeprom->Spill < 0xFF)
+                heeprom->Spill++;
+            heeprom->Free++;
+        }
+        return (flashStatus == FLASH_COMPLETE) ? EEPROM_OK : EEPROM_FLASH_ERROR;
     }
     
-    count = EE_GetVariablesCount(pageBase, Address, heeprom->PageSize) + 1;
+    count = EE_IndexCount(heeprom, Address);
+    if (count == 0xFFFF)
+        count = EE_GetVariablesCount(pageBase, Address, heeprom->PageSize);
+    count++;
     if (count >= (heeprom->PageSize / 4 - 1))
         return EEPROM_OUT_SIZE;
     
@@ -323,13 +430,16 @@ static uint16_t EE_VerifyPageFullWriteVariable(EEPROM_HandleTypeDef *heeprom, ui
         return EEPROM_FLASH_ERROR;
     }
     
-    flashStatus = FLASH_ProgramHalfWord(newPage + 6, Address);
+    flashStatus = FLASH_ProgramHalfWord(newPage + 6, EE_Tag(Address, Data));
     FLASH_Lock();
     
     if (flashStatus != FLASH_COMPLETE)
         return EEPROM_FLASH_ERROR;
     
-    return EE_PageTransfer(heeprom, newPage, pageBase, Address);
+    uint16_t result = EE_PageTransfer(heeprom, newPage, pageBase, Address);
+    if (heeprom->Active)
+        EE_IndexBuild(heeprom);  // New page, new slots
+    return result;
 }
 
 /* ==================== Public API ==================== */
@@ -375,6 +485,13 @@ uint16_t EEPROM_Init(EEPROM_HandleTypeDef *heeprom) {
             } else if (status1 == EEPROM_ERASED) {
                 EEPROM_LOG("   ⚠️  Both erased-format");
                 heeprom->Status = EEPROM_Format(heeprom);
+            } else {
+                /* Marking P1 valid was cut: it is the only page with data */
+                EEPROM_LOG("   ⚠️  P1 torn mark-activate");
+                FLASH_Unlock();
+                flashStatus = FLASH_ProgramHalfWord(heeprom->PageBase1, EEPROM_VALID_PAGE);
+                FLASH_Lock();
+                heeprom->Status = (flashStatus == FLASH_COMPLETE) ? EEPROM_OK : EEPROM_FLASH_ERROR;
             }
             break;
             
@@ -383,7 +500,8 @@ uint16_t EEPROM_Init(EEPROM_HandleTypeDef *heeprom) {
             if (status1 == EEPROM_VALID_PAGE) {
                 EEPROM_LOG("   🔄 P1 active-xfer to P0");
                 heeprom->Status = EE_PageTransfer(heeprom, heeprom->PageBase0, heeprom->PageBase1, 0xFFFF);
-            } else if (status1 == EEPROM_ERASED) {
+            } else {
+                /* P1 erased, or its erase was cut after the transfer */
                 EEPROM_LOG("   ✅ P1 erased-activate P0");
                 heeprom->Status = EE_CheckErasePage(heeprom->PageBase1, EEPROM_ERASED, heeprom->PageSize);
                 if (heeprom->Status == EEPROM_OK) {
@@ -421,11 +539,22 @@ uint16_t EEPROM_Init(EEPROM_HandleTypeDef *heeprom) {
                 FLASH_Lock();
                 heeprom->Status = (flashStatus == FLASH_COMPLETE) ? 
                     EE_CheckErasePage(heeprom->PageBase0, EEPROM_ERASED, heeprom->PageSize) : EEPROM_FLASH_ERROR;
+            } else if (status1 == EEPROM_ERASED) {
+                /* Marking P0 valid was cut: it is the only page with data */
+                EEPROM_LOG("   ⚠️  P0 torn mark-activate");
+                FLASH_Unlock();
+                flashStatus = FLASH_ProgramHalfWord(heeprom->PageBase0, EEPROM_VALID_PAGE);
+                FLASH_Lock();
+                heeprom->Status = (flashStatus == FLASH_COMPLETE) ? EEPROM_OK : EEPROM_FLASH_ERROR;
+            } else {
+                EEPROM_LOG("   ❌ Both unknown-format");
+                heeprom->Status = EEPROM_Format(heeprom);
             }
             break;
     }
     
     if (heeprom->Status == EEPROM_OK) {
+        EE_IndexBuild(heeprom);
         EEPROM_LOG("✅ Init OK\r\n");
     } else {
         EEPROM_LOG("❌ Init err 0x%02X\r\n", heeprom->Status);
@@ -466,6 +595,8 @@ uint16_t EEPROM_Format(EEPROM_HandleTypeDef *heeprom) {
     EEPROM_LOG("   Erase P1...");
     status = EE_CheckErasePage(heeprom->PageBase1, EEPROM_ERASED, heeprom->PageSize);
     if (status == EEPROM_OK) {
+        if (heeprom->Active)
+            EE_IndexBuild(heeprom);
         EEPROM_LOG("✅ FORMAT OK\r\n");
     } else {
         EEPROM_LOG("❌ P1 err:0x%02X\r\n", status);
@@ -473,11 +604,32 @@ uint16_t EEPROM_Format(EEPROM_HandleTypeDef *heeprom) {
     return status;
 }
 
+/**
+  * @brief  Find latest record by scanning the valid page backwards
+  */
+static uint16_t EE_ReadScan(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t *Data) {
+    uint32_t pageBase, pageEnd;
+    
+    pageBase = EE_FindValidPage(heeprom);
+    if (pageBase == 0)
+        return EEPROM_NO_VALID_PAGE;
+    
+    pageEnd = pageBase + heeprom->PageSize - 2;
+    
+    for (uint32_t addr = pageEnd; addr >= pageBase + 6; addr -= 4) {
+        if (EE_RecAddress(addr) == Address) {
+            *Data = (*(__IO uint16_t*)(addr - 2));
+            return EEPROM_OK;
+        }
+    }
+    return EEPROM_BAD_ADDRESS;
+}
+
 /**
   * @brief  Read variable from EEPROM
   */
 uint16_t EEPROM_Read(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t *Data) {
-    uint32_t pageBase, pageEnd;
+    uint16_t status;
     
     if (!heeprom || !Data)
         return EEPROM_BAD_ADDRESS;
@@ -489,22 +641,25 @@ uint16_t EEPROM_Read(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t *
             return heeprom->Status;
     }
     
-    pageBase = EE_FindValidPage(heeprom);
-    if (pageBase == 0)
-        return EEPROM_NO_VALID_PAGE;
-    
-    pageEnd = pageBase + heeprom->PageSize - 2;
-    
-    for (uint32_t addr = pageEnd; addr >= pageBase + 6; addr -= 4) {
-        if ((*(__IO uint16_t*)addr) == Address) {
-            *Data = (*(__IO uint16_t*)(addr - 2));
-            EEPROM_LOG("📖 Rd %d→%d", Address, *Data);
-            return EEPROM_OK;
+    /* O(1): slot straight from the RAM index */
+    if (heeprom->Active && Address < EEPROM_INDEX_SIZE) {
+        uint8_t slot = heeprom->Index[Address];
+        if (slot == 0) {
+            EEPROM_LOG("❓ Rd %d NF", Address);
+            return EEPROM_BAD_ADDRESS;
         }
+        *Data = (*(__IO uint16_t*)(heeprom->Active + slot * 4));
+        EEPROM_LOG("📖 Rd %d→%d", Address, *Data);
+        return EEPROM_OK;
     }
     
-    EEPROM_LOG("❓ Rd %d NF", Address);
-    return EEPROM_BAD_ADDRESS;
+    status = EE_ReadScan(heeprom, Address, Data);
+    if (status == EEPROM_OK) {
+        EEPROM_LOG("📖 Rd %d→%d", Address, *Data);
+    } else {
+        EEPROM_LOG("❓ Rd %d NF", Address);
+    }
+    return status;
 }
 
 /**
@@ -518,7 +673,7 @@ uint16_t EEPROM_Write(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t
     //         return heeprom->Status;
     // }
     
-    if (Address == 0xFFFF) return EEPROM_BAD_ADDRESS;
+    if (Address >= 0xFF) return EEPROM_BAD_ADDRESS;  // Address is one byte of the tag
     
     EEPROM_LOG("Wr id:%d:%d", Address, Data);
     uint16_t result = EE_VerifyPageFullWriteVariable(heeprom, Address, Data);
@@ -562,7 +717,9 @@ uint16_t EEPROM_Count(EEPROM_HandleTypeDef *heeprom, uint16_t *Count) {
     if (pageBase == 0)
         return EEPROM_NO_VALID_PAGE;
     
-    *Count = EE_GetVariablesCount(pageBase, 0xFFFF, heeprom->PageSize);
+    *Count = EE_IndexCount(heeprom, 0xFFFF);
+    if (*Count == 0xFFFF)
+        *Count = EE_GetVariablesCount(pageBase, 0xFFFF, heeprom->PageSize);
     EEPROM_LOG("📊 Vars:%d/%d", *Count, EEPROM_MaxCount(heeprom));
     return EEPROM_OK;
 }
@@ -597,4 +754,4 @@ uint16_t EEPROM_Erases(EEPROM_HandleTypeDef *heeprom, uint16_t *Erases) {
     *Erases = (*(__IO uint16_t*)(pageBase + 2));
     EEPROM_LOG("🔢 Erases:%d", *Erases);
     return EEPROM_OK;
-}
\ No newline at end of file
+}
@@ -1,96 +1,221 @@
 #include "buzzer_tunes.h"
 
-extern void delay (int time);
-
-void delayUsTone(uint32_t n)
-{
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n;
-
-    SysTick->CMP = 9999999;
-    SysTick->CNT = 0;
-    //SysTick->CTLR |=(1 << 0);
-
-    while(SysTick->CNT <= i);
-    //SysTick->CTLR &= ~(1 << 0);
-    //SysTick->CTLR = 0xB;
-    
-    SysTick->CNT = 0;
-    SysTick->CMP = 999;
-    
+// ާާ֧ ߧ PC1 = TIM2_CH1 (Partial Remap 2). ֧ѧߧէ ԧ֧ߧ֧ڧ֧ ѧۧާ֧,
+//  SysTick (1 ާ) ڧӧѧ֧ էݧڧ֧ݧߧ ߧ  ҧ֧ק ݧ֧է ڧ ֧֧է.
+// tone1()/tone1_vol()/Buzzer_Play() ݧܧ ܧݧѧէ ٧ӧ  ֧֧է  ѧ٧ ӧ٧ӧѧѧ.
+
+#define BUZZER_TICK_HZ 1000000UL  // ѧܧ TIM2: 1 , ARR/CCR  ާڧܧ֧ܧߧէѧ
+
+#ifndef BUZZER_QUEUE_SIZE
+#define BUZZER_QUEUE_SIZE 8  // ѧ٧ާ֧ ֧֧է (֧֧ߧ էӧۧܧ)
+#endif
+
+typedef struct {
+    const uint8_t *melody;  // ֧ݧէڧ ӧ flash (NULL = էڧߧߧ )
+    uint16_t arr;           // ֧ڧ  ާܧ (0 = ѧ٧)
+    uint16_t ccr;           // ݧڧ֧ݧߧ ڧާݧ  ާܧ
+    uint16_t ms;            // ݧڧ֧ݧߧ ߧ
+} buzzer_note_t;
+
+static buzzer_note_t buzzer_queue[BUZZER_QUEUE_SIZE];
+static volatile uint8_t buzzer_head = 0;       // ڧ֧ ݧܧ ߧӧߧ ڧܧ
+static volatile uint8_t buzzer_tail = 0;       // ڧ֧ ݧܧ SysTick
+static volatile uint16_t buzzer_left_ms = 0;   // ܧݧܧ ѧݧ ٧ӧѧ ֧ܧ֧ ߧ
+
+// ֧ܧӧ֧ߧ ֧ܧ֧ ާ֧ݧէڧ (ݧܧ SysTick)
+static const uint8_t *buzzer_melody = NULL;
+static uint8_t buzzer_base;  // ҧݧߧ ݧ ߧ  ڧߧէ֧ܧ 1
+static uint8_t buzzer_unit;  // ѧܧ, ާ
+static uint8_t buzzer_duty;  // ܧӧѧاߧ, 1/256 ֧ڧէ
+
+// ֧ڧ (ާܧ) ݧߧ ܧѧӧ 3: C3..B3.  - էӧڧ ӧѧӧ ߧ ߧާ֧ ܧѧӧ.
+static const uint16_t buzzer_scale[12] = {
+    7645, 7215, 6810, 6428, 6067, 5727, 5405, 5102, 4816, 4545, 4290, 4050};
+
+// ߧاڧ֧ݧ ѧܧ էݧ ܧէ էݧڧ֧ݧߧ BZ_LEN_x
+static const uint8_t buzzer_len[8] = {1, 2, 3, 4, 5, 6, 8, 12};
+
+/*********************************************************************
+ * @fn      Buzzer_Init
+ *
+ * @brief   ѧۧܧ TIM2 CH1 (PC1)  ֧اڧ PWM1, ѧܧ 1 , ڧڧߧ
+ *
+ * @return  none
+ */
+void Buzzer_Init (void) {
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+    TIM_OCInitTypeDef TIM_OCInitStructure = {0};
+
+    RCC_APB2PeriphClockCmd (RCC_APB2Periph_GPIOC | RCC_APB2Periph_AFIO, ENABLE);
+    RCC_APB1PeriphClockCmd (RCC_APB1Periph_TIM2, ENABLE);
+
+    // PC1 -> TIM2_CH1
+    GPIO_PinRemapConfig (GPIO_PartialRemap2_TIM2, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
+    GPIO_Init (GPIOC, &GPIO_InitStructure);
+
+    TIM_TimeBaseInitStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = SystemCoreClock / BUZZER_TICK_HZ - 1;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit (TIM2, &TIM_TimeBaseInitStructure);
+
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
+    TIM_OCInitStructure.TIM_Pulse = 0;  // CCR=0 -> ӧ ӧ֧ԧէ  0
+    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
+    TIM_OC1Init (TIM2, &TIM_OCInitStructure);
+
+    TIM_OC1PreloadConfig (TIM2, TIM_OCPreload_Enable);
+    TIM_ARRPreloadConfig (TIM2, ENABLE);
+    TIM_Cmd (TIM2, ENABLE);
+
+    buzzer_tail = buzzer_head;
+    buzzer_left_ms = 0;
+    buzzer_melody = NULL;
 }
 
-// ֧ߧ֧ѧڧ ߧ ٧ѧէѧߧߧ ѧ  էݧڧ֧ݧߧ
-void tone1(uint16_t frequency, uint16_t duration_ms) {
-    if(frequency == 0) {
-        BUZZER_OFF;
-        delay(duration_ms);
-        return;
-    }
-    
-    uint32_t period_us = 1000000UL / frequency;
-    uint32_t half_period_us = period_us / 2;
-    uint32_t cycles = (uint32_t)duration_ms * 1000UL / period_us;
-    
-    for(uint32_t i = 0; i < cycles; i++) {
-        BUZZER_ON;
-        delayUsTone(half_period_us);
-        BUZZER_OFF;
-        delayUsTone(half_period_us);
-    }
+// ѧԧ٧ڧ ߧ  TIM2
+static void Buzzer_Load (uint16_t arr, uint16_t ccr, uint16_t ms) {
+    TIM2->ATRLR = arr ? arr - 1 : 0xFFFF;
+    TIM2->CH1CVR = ccr;
+    TIM2->SWEVGR = TIM_UG;  // ѧԧ٧ڧ ARR/CCR ѧ٧, ߧ էاڧէѧ ܧߧ ѧԧ ֧ڧէ
+    buzzer_left_ms = ms;
 }
 
+// ݧ֧էѧ ߧ ާ֧ݧէڧ. 0 - ާ֧ݧէڧ ٧ѧܧߧڧݧѧ.
+static int Buzzer_NextMelodyNote (void) {
+    uint8_t b = *buzzer_melody;
+    if (b == BZ_END) {
+        buzzer_melody = NULL;
+        return 0;
+    }
+    buzzer_melody++;
 
-
-
-// ֧ߧ֧ѧڧ ߧ  ԧާܧ (0-100%)
-void tone1_vol(uint16_t frequency, uint16_t duration_ms, uint8_t volume) {
-    if(frequency == 0 || volume == 0) {
-        BUZZER_OFF;
-        delay(duration_ms);
-        return;
+    // ާ֧ߧ ԧާܧ: ݧ֧էڧ ҧѧۧ - ߧӧѧ ܧӧѧاߧ է ܧߧ ާ֧ݧէڧ
+    if (b == BZ_VOL_CODE) {
+        buzzer_duty = *buzzer_melody++;
+        b = *buzzer_melody++;
     }
-    
-    // ԧѧߧڧڧ ԧާܧ 0-100%
-    if(volume > 100) volume = 100;
-    
-    uint32_t period_us = 1000000UL / frequency;
-    uint32_t half_period_us = period_us / 2;
-    uint32_t cycles = (uint32_t)duration_ms * 1000UL / period_us;
-    
-    // ֧ާ ON  ֧ߧѧ  ݧ֧ڧէ (duty cycle)
-    uint32_t on_time_us = (half_period_us * volume) / 100;
-    uint32_t off_time_us = half_period_us - on_time_us;
-    
-    for(uint32_t i = 0; i < cycles; i++) {
-        // ݧاڧ֧ݧߧѧ ݧӧݧߧ
-        BUZZER_ON;
-        delayUsTone(on_time_us);
-        BUZZER_OFF;
-        delayUsTone(off_time_us);
-        
-        // ڧѧ֧ݧߧѧ ݧӧݧߧ (ѧ٧)
-        delayUsTone(half_period_us);
+
+    uint16_t arr = 0;
+    uint16_t ccr = 0;
+    uint8_t note = b & 0x1F;
+    if (note) {
+        uint8_t s = buzzer_base + note - 1;
+        uint8_t oct = 0;
+        while (s >= 12) {
+            s -= 12;
+            oct++;
+        }
+        arr = buzzer_scale[s] >> oct;
+        ccr = ((uint32_t)arr * buzzer_duty) >> 8;
     }
+    Buzzer_Load (arr, ccr, (uint16_t)buzzer_unit * buzzer_len[b >> 5]);
+    return 1;
 }
 
+/*********************************************************************
+ * @fn      Buzzer_Tick
+ *
+ * @brief   ٧ӧѧ֧ ڧ SysTick_Handler ܧѧاէ 1 ާ. ֧֧ܧݧѧ֧ ߧ.
+ *
+ * @return  none
+ */
+void Buzzer_Tick (void) {
+    if (buzzer_left_ms) {
+        if (--buzzer_left_ms)
+            return;
+    }
 
+    while (1) {
+        if (buzzer_melody && Buzzer_NextMelodyNote())
+            return;
 
+        if (buzzer_tail == buzzer_head) {
+            TIM2->CH1CVR = 0;  // ֧֧է  - ڧڧߧ
+            return;
+        }
 
+        buzzer_note_t *n = &buzzer_queue[buzzer_tail & (BUZZER_QUEUE_SIZE - 1)];
+        buzzer_tail++;
 
+        if (n->melody) {
+            // ѧԧݧӧ: ҧѧ٧ӧ ݧ, ѧܧ, ܧӧѧاߧ
+            buzzer_base = n->melody[0];
+            buzzer_unit = n->melody[1];
+            buzzer_duty = n->melody[2];
+            buzzer_melody = n->melody + 3;
+            continue;
+        }
 
+        Buzzer_Load (n->arr, n->ccr, n->ms);
+        return;
+    }
+}
 
+//  ݧ ֧  ڧԧѧ
+int Buzzer_IsBusy (void) {
+    return (buzzer_tail != buzzer_head) || buzzer_left_ms || buzzer_melody;
+}
 
+// اէѧ ܧߧѧߧڧ ӧ֧ ߧ (֧֧ ߧ, ҧ  ..)
+void Buzzer_Wait (void) {
+    while (Buzzer_IsBusy()) {
+        __NOP();
+    }
+}
 
+// ֧ӧѧ ٧ӧ  ڧڧ ֧֧է
+void Buzzer_Stop (void) {
+    __disable_irq();
+    buzzer_tail = buzzer_head;
+    buzzer_left_ms = 0;
+    buzzer_melody = NULL;
+    TIM2->CH1CVR = 0;
+    __enable_irq();
+}
 
+// ݧاڧ ݧ֧ާ֧ߧ  ֧֧է. ֧֧է ݧߧ - اէק, ܧ SysTick ӧҧէڧ ާ֧.
+static void Buzzer_Push (const buzzer_note_t *n) {
+    while ((uint8_t)(buzzer_head - buzzer_tail) >= BUZZER_QUEUE_SIZE) {
+        __NOP();
+    }
 
+    buzzer_queue[buzzer_head & (BUZZER_QUEUE_SIZE - 1)] = *n;
+    buzzer_head++;
+}
 
+// ԧѧ ާ֧ݧէڧ ڧ flash (ާѧ BZ_*  buzzer_tunes.h), ߧ֧ҧݧܧڧѧ
+void Buzzer_Play (const uint8_t *melody) {
+    buzzer_note_t n = {melody, 0, 0, 0};
+    Buzzer_Push (&n);
+}
 
+// ֧ߧ֧ѧڧ ߧ  ԧާܧ (0-100%), ߧ֧ҧݧܧڧѧ
+void tone1_vol(uint16_t frequency, uint16_t duration_ms, uint8_t volume) {
+    buzzer_note_t n = {NULL, 0, 0, duration_ms};
 
+    // ԧѧߧڧڧ ԧާܧ 0-100%
+    if(volume > 100) volume = 100;
 
+    // ڧا 16  ֧ڧ ߧ ާ֧ѧ֧  16-ҧڧߧ ARR - ڧѧ֧ ѧ٧
+    if(frequency >= 16 && volume != 0) {
+        n.arr = BUZZER_TICK_HZ / frequency;
+        // ާݧ = volume%  ݧ֧ڧէ, ܧѧ  ֧اߧ֧ԧ ԧѧާާߧԧ ާ֧ѧߧէ
+        n.ccr = ((uint32_t)n.arr * volume) / 200;
+    }
 
+    Buzzer_Push (&n);
+}
+
+// ֧ߧ֧ѧڧ ߧ ٧ѧէѧߧߧ ѧ  էݧڧ֧ݧߧ (ާ֧ѧߧէ 50%), ߧ֧ҧݧܧڧѧ
+void tone1(uint16_t frequency, uint16_t duration_ms) {
+    tone1_vol(frequency, duration_ms, 100);
+}
 
 
 
@@ -98,157 +223,160 @@ void tone1_vol(uint16_t frequency, uint16_t duration_ms, uint8_t volume) {
 //    
 // ------------------------
 
-void buzzer_ok(void) {
-    tone1(1000, 80);
-    tone1(1500, 80);
-}
+// ڧ٧ܧڧ ٧ӧܧ: G3..C#6
+#define BZ_BASE BZ_NOTE (G, 3)
 
+const uint8_t tune_error[] = {BZ_HEADER (50, 100), BZ (G, 4, 3), BZ (G, 3, 4), BZ_END};
 
-void buzzer_error(void) {
-    tone1(400, 150);
-    tone1(200, 200);
-}
+const uint8_t tune_error_strong[] = {BZ_HEADER (50, 100), BZ (D, 4, 4), BZ_REST (1), BZ (D, 4, 4), BZ_END};
 
-void buzzer_error_strong(void) {
-    tone1(300, 200);
-    tone1(0, 50);
-    tone1(300, 200);
-}
+const uint8_t tune_critical[] = {BZ_HEADER (40, 100),
+                                 BZ (B, 3, 5), BZ_REST (2),
+                                 BZ (B, 3, 5), BZ_REST (2),
+                                 BZ (B, 3, 5), BZ_REST (2), BZ_END};
 
-void buzzer_warning(void) {
-    tone1(800, 150);
-}
+const uint8_t tune_access_denied[] = {BZ_HEADER (24, 100), BZ (D, 5, 3), BZ (G, 4, 5), BZ_END};
 
-void buzzer_warning_double(void) {
-    tone1(800, 120);
-    tone1(0, 60);
-    tone1(800, 120);
-}
+#undef BZ_BASE
 
-void buzzer_click(void) {
-    tone1(1200, 40);
-}
+// ܧڧ ٧ӧܧ: D5..G#7
+#define BZ_BASE BZ_NOTE (D, 5)
 
-void buzzer_success_long(void) {
-    tone1(800, 150);
-    tone1(1000, 150);
-    tone1(1200, 200);
-}
+const uint8_t tune_ok[] = {BZ_HEADER (20, 100), BZ (B, 5, 4), BZ (Fs, 6, 4), BZ_END};
 
-void buzzer_critical(void) {
-    for (int i = 0; i < 3; i++) {
-        tone1(250, 200);
-        tone1(0, 80);
-    }
-}
+const uint8_t tune_warning[] = {BZ_HEADER (50, 100), BZ (G, 5, 3), BZ_END};
 
-void buzzer_beepboop(void) {
-    tone1(1000, 60);
-    tone1(700, 60);
-}
+const uint8_t tune_warning_double[] = {BZ_HEADER (20, 100), BZ (G, 5, 6), BZ_REST (3), BZ (G, 5, 6), BZ_END};
 
-void buzzer_access_denied(void) {
-    tone1(600, 70);
-    tone1(400, 120);
-}
+const uint8_t tune_click[] = {BZ_HEADER (20, 100), BZ (D, 6, 2), BZ_END};
 
-void buzzer_notify(void) {
-    tone1(1000, 100);
-    tone1(800, 150);
-}
+const uint8_t tune_success_long[] = {BZ_HEADER (50, 100), BZ (G, 5, 3), BZ (B, 5, 3), BZ (D, 6, 4), BZ_END};
+
+const uint8_t tune_beepboop[] = {BZ_HEADER (20, 100), BZ (B, 5, 3), BZ (F, 5, 3), BZ_END};
+
+const uint8_t tune_notify[] = {BZ_HEADER (50, 100), BZ (B, 5, 2), BZ (G, 5, 3), BZ_END};
 
 // ------------------------
 //    
 // ------------------------
 
-void buzzer_ios_click(void) {
-    tone1(1800, 25);
-}
-
-void buzzer_android_notify(void) {
-    tone1(1200, 70);
-    tone1(1500, 120);
-}
+const uint8_t tune_ios_click[] = {BZ_HEADER (25, 100), BZ (A, 6, 1), BZ_END};
 
-void buzzer_robot(void) {
-    tone1(800, 70);
-    tone1(1000, 70);
-    tone1(600, 90);
-}
+const uint8_t tune_android_notify[] = {BZ_HEADER (24, 100), BZ (D, 6, 3), BZ (Fs, 6, 5), BZ_END};
 
-void buzzer_microwave_done(void) {
-    tone1(1000, 200);
-    tone1(0, 100);
-    tone1(1000, 200);
-}
+const uint8_t tune_robot[] = {BZ_HEADER (23, 100), BZ (G, 5, 3), BZ (B, 5, 3), BZ (D, 5, 4), BZ_END};
 
-void buzzer_winxp_msg(void) {
-    tone1(900, 80);
-    tone1(1200, 80);
-    tone1(1000, 120);
-}
+const uint8_t tune_microwave_done[] = {BZ_HEADER (50, 100), BZ (B, 5, 4), BZ_REST (2), BZ (B, 5, 4), BZ_END};
 
+const uint8_t tune_winxp_msg[] = {BZ_HEADER (20, 100), BZ (A, 5, 4), BZ (D, 6, 4), BZ (B, 5, 6), BZ_END};
 
 // ------------------------
 //     STARTUP
 // ------------------------
 // ԧܧѧ ӧէѧ ާ֧ݧէڧ, ܧѧ ӧܧݧ֧ߧڧ ۧӧ
-void buzzer_startup(void) {
-    tone1(800, 120);
-    tone1(1000, 120);
-    tone1(1300, 160);
-}
+const uint8_t tune_startup[] = {BZ_HEADER (20, 100), BZ (G, 5, 6), BZ (B, 5, 6), BZ (E, 6, 8), BZ_END};
 
 // ------------------------
 //     SHUTDOWN
 // ------------------------
 // ҧѧߧѧ, ߧڧէѧ
-void buzzer_shutdown(void) {
-    tone1(1200, 150);
-    tone1(900, 150);
-    tone1(600, 180);
-}
+const uint8_t tune_shutdown[] = {BZ_HEADER (30, 100), BZ (D, 6, 5), BZ (A, 5, 5), BZ (D, 5, 6), BZ_END};
 
 // ------------------------
 //     CHARGING
 // ------------------------
 // ӧ "ڧߧ", ܧѧ էܧݧ֧ߧڧ ڧѧߧڧ
-void buzzer_charging(void) {
-    tone1(1500, 80);
-    tone1(1800, 150);
-}
-
-
-
-
-
-
-
-
-
+const uint8_t tune_charging[] = {BZ_HEADER (25, 100), BZ (Fs, 6, 3), BZ (A, 6, 6), BZ_END};
 
 // ===   ===
-void beep_Increment_Max(void) {
-    // ӧ "ҧݧ ߧ֧ݧ٧"
-    tone1_vol(1500, 80, 90);
-    delay(40);
-    tone1_vol(1500, 80, 90);
-    delay(40);
-    tone1_vol(1200, 100, 70);  // ܧ ߧѧ٧ѧ
-}
+// ӧ "ҧݧ ߧ֧ݧ٧", ݧ֧էߧ ߧ - ܧ ߧѧ٧ѧ
+const uint8_t tune_increment_max[] = {BZ_HEADER (20, 90),
+                                      BZ (Fs, 6, 4), BZ_REST (2),
+                                      BZ (Fs, 6, 4), BZ_REST (2),
+                                      BZ_VOL (70), BZ (D, 6, 5), BZ_END};
 
 // ===   ===
-void beep_Decrement_Min(void) {
-    // ӧ "ާ֧ߧ ߧ֧ݧ٧"
-    tone1_vol(800, 80, 90);
-    delay(40);
-    tone1_vol(800, 80, 90);
-    delay(40);
-    tone1_vol(1000, 100, 70);  // ܧ ߧѧ٧ѧ
-}
+// ӧ "ާ֧ߧ ߧ֧ݧ٧", ݧ֧էߧ ߧ - ܧ ߧѧ٧ѧ
+const uint8_t tune_decrement_min[] = {BZ_HEADER (20, 90),
+                                      BZ (G, 5, 4), BZ_REST (2),
+                                      BZ (G, 5, 4), BZ_REST (2),
+                                      BZ_VOL (70), BZ (B, 5, 5), BZ_END};
 
-void beep_Save(void) {
-    // ܧڧ ӧէڧ ٧ӧ "٧ѧڧѧߧ!"
-    tone1_vol(1000, 40, 70);
-    tone1_vol(1500, 80, 100);
-}
\ No newline at end of file
+// ܧڧ ӧէڧ ٧ӧ "٧ѧڧѧߧ!"
+const uint8_t tune_save[] = {BZ_HEADER (20, 70), BZ (B, 5, 2), BZ_VOL (100), BZ (Fs, 6, 4), BZ_END};
+
+#undef BZ_BASE
+
+// ------------------------
+//     
+// ------------------------
+// ѧէѧ  ڧӧܧ, ݧܧ ֧ݧ ԧէ- ӧ٧ӧѧ Buzzer_Play()
+
+#define BZ_BASE BZ_NOTE (C, 5)
+
+const uint8_t melody_Nokia[] = {BZ_HEADER (80, 100),
+                                BZ (E, 6, 2), BZ (D, 6, 2), BZ (Fs, 5, 4), BZ (Gs, 5, 4),
+                                BZ (Cs, 6, 2), BZ (B, 5, 2), BZ (D, 5, 4), BZ (E, 5, 4),
+                                BZ (B, 5, 2), BZ (A, 5, 2), BZ (Cs, 5, 4), BZ (E, 5, 4),
+                                BZ (A, 5, 8), BZ_END};
+
+const uint8_t melody_OdeToJoy[] = {BZ_HEADER (75, 100),
+                                   BZ (E, 5, 4), BZ (E, 5, 4), BZ (F, 5, 4), BZ (G, 5, 4),
+                                   BZ (G, 5, 4), BZ (F, 5, 4), BZ (E, 5, 4), BZ (D, 5, 4),
+                                   BZ (C, 5, 4), BZ (C, 5, 4), BZ (D, 5, 4), BZ (E, 5, 4),
+                                   BZ (E, 5, 6), BZ (D, 5, 2), BZ (D, 5, 8), BZ_END};
+
+const uint8_t melody_JingleBells[] = {BZ_HEADER (60, 100),
+                                      BZ (E, 5, 4), BZ (E, 5, 4), BZ (E, 5, 8),
+                                      BZ (E, 5, 4), BZ (E, 5, 4), BZ (E, 5, 8),
+                                      BZ (E, 5, 4), BZ (G, 5, 4), BZ (C, 5, 6), BZ (D, 5, 2),
+                                      BZ (E, 5, 12), BZ_REST (4),
+                                      BZ (F, 5, 4), BZ (F, 5, 4), BZ (F, 5, 6), BZ (F, 5, 2),
+                                      BZ (F, 5, 4), BZ (E, 5, 4), BZ (E, 5, 4), BZ (E, 5, 2), BZ (E, 5, 2),
+                                      BZ (E, 5, 4), BZ (D, 5, 4), BZ (D, 5, 4), BZ (E, 5, 4),
+                                      BZ (D, 5, 8), BZ (G, 5, 8), BZ_END};
+
+const uint8_t melody_FurElise[] = {BZ_HEADER (120, 100),
+                                   BZ (E, 6, 1), BZ (Ds, 6, 1), BZ (E, 6, 1), BZ (Ds, 6, 1),
+                                   BZ (E, 6, 1), BZ (B, 5, 1), BZ (D, 6, 1), BZ (C, 6, 1),
+                                   BZ (A, 5, 2), BZ_REST (1), BZ (C, 5, 1), BZ (E, 5, 1), BZ (A, 5, 1),
+                                   BZ (B, 5, 2), BZ_REST (1), BZ (E, 5, 1), BZ (Gs, 5, 1), BZ (B, 5, 1),
+                                   BZ (C, 6, 2), BZ_REST (1), BZ (E, 5, 1),
+                                   BZ (E, 6, 1), BZ (Ds, 6, 1), BZ (E, 6, 1), BZ (Ds, 6, 1),
+                                   BZ (E, 6, 1), BZ (B, 5, 1), BZ (D, 6, 1), BZ (C, 6, 1),
+                                   BZ (A, 5, 4), BZ_END};
+
+#undef BZ_BASE
+
+#define BZ_BASE BZ_NOTE (G, 4)
+
+const uint8_t melody_SuperMario[] = {BZ_HEADER (75, 100),
+                                     BZ (E, 5, 2), BZ (E, 5, 2), BZ_REST (2), BZ (E, 5, 2),
+                                     BZ_REST (2), BZ (C, 5, 2), BZ (E, 5, 4),
+                                     BZ (G, 5, 4), BZ_REST (4), BZ (G, 4, 4), BZ_END};
+
+const uint8_t melody_Tetris[] = {BZ_HEADER (70, 100),
+                                 BZ (E, 5, 4), BZ (B, 4, 2), BZ (C, 5, 2), BZ (D, 5, 4), BZ (C, 5, 2), BZ (B, 4, 2),
+                                 BZ (A, 4, 4), BZ (A, 4, 2), BZ (C, 5, 2), BZ (E, 5, 4), BZ (D, 5, 2), BZ (C, 5, 2),
+                                 BZ (B, 4, 6), BZ (C, 5, 2), BZ (D, 5, 4), BZ (E, 5, 4),
+                                 BZ (C, 5, 4), BZ (A, 4, 4), BZ (A, 4, 8), BZ_END};
+
+const uint8_t melody_HappyBirthday[] = {BZ_HEADER (100, 100),
+                                        BZ (G, 4, 3), BZ (G, 4, 1), BZ (A, 4, 4), BZ (G, 4, 4), BZ (C, 5, 4), BZ (B, 4, 8),
+                                        BZ (G, 4, 3), BZ (G, 4, 1), BZ (A, 4, 4), BZ (G, 4, 4), BZ (D, 5, 4), BZ (C, 5, 8),
+                                        BZ (G, 4, 3), BZ (G, 4, 1), BZ (G, 5, 4), BZ (E, 5, 4), BZ (C, 5, 4), BZ (B, 4, 4), BZ (A, 4, 8),
+                                        BZ (F, 5, 3), BZ (F, 5, 1), BZ (E, 5, 4), BZ (C, 5, 4), BZ (D, 5, 4), BZ (C, 5, 8),
+                                        BZ_END};
+
+#undef BZ_BASE
+
+#define BZ_BASE BZ_NOTE (E, 4)
+
+const uint8_t melody_ImperialMarch[] = {BZ_HEADER (125, 100),
+                                        BZ (A, 4, 4), BZ (A, 4, 4), BZ (A, 4, 4), BZ (F, 4, 3), BZ (C, 5, 1),
+                                        BZ (A, 4, 4), BZ (F, 4, 3), BZ (C, 5, 1), BZ (A, 4, 8),
+                                        BZ (E, 5, 4), BZ (E, 5, 4), BZ (E, 5, 4), BZ (F, 5, 3), BZ (C, 5, 1),
+                                        BZ (Gs, 4, 4), BZ (F, 4, 3), BZ (C, 5, 1), BZ (A, 4, 8),
+                                        BZ_END};
+
+#undef BZ_BASE
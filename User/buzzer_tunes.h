@@ -7,76 +7,119 @@
 
 #include "debug.h"
 
-extern void melody_Nokia(void);
-extern void melody_iPhoneMarimba(void);
-extern void melody_SamsungWhistle(void);
+// ---   ---
+// ֧ݧէڧ - ާѧڧ const uint8_t ӧ flash, ڧԧѧ֧ Buzzer_Play():
+//   [0] ҧѧ٧ӧ ݧ BZ_BASE, [1] ѧܧ  ާ, [2] ܧӧѧاߧ (1/256 ֧ڧէ)
+//   էѧݧ֧  ҧѧۧ ߧ ߧ: [7:5] ܧ էݧڧ֧ݧߧ, [4:0] ߧ
+//   (0 = ѧ٧, 1..30 = BZ_BASE + n - 1),  ܧߧ BZ_END.
+//   BZ_VOL (ԧާܧ) ֧֧ ߧ - ߧӧѧ ԧާܧ   ߧ է ܧߧ.
+// ֧֧ ѧҧݧڧ֧ ٧ѧէѧ #define BZ_BASE BZ_NOTE (ߧ, ܧѧӧ) - ѧާѧ ߧڧ٧ܧѧ
+// ߧ ѧҧݧڧ, էڧѧѧ٧ ާ֧ݧէڧ ߧ ҧݧ 30 ݧߧ.
+#define BZ_N_C  0
+#define BZ_N_Cs 1
+#define BZ_N_D  2
+#define BZ_N_Ds 3
+#define BZ_N_E  4
+#define BZ_N_F  5
+#define BZ_N_Fs 6
+#define BZ_N_G  7
+#define BZ_N_Gs 8
+#define BZ_N_A  9
+#define BZ_N_As 10
+#define BZ_N_B  11
+
+// ݧڧ֧ݧߧ  ѧܧѧ -> ܧ
+#define BZ_LEN_1  0
+#define BZ_LEN_2  1
+#define BZ_LEN_3  2
+#define BZ_LEN_4  3
+#define BZ_LEN_5  4
+#define BZ_LEN_6  5
+#define BZ_LEN_8  6
+#define BZ_LEN_12 7
+
+#define BZ_NOTE(n, oct) (BZ_N_##n + ((oct) - 3) * 12)  // ݧ  C3
+
+// ߧէ֧ܧ ߧ ߧڧ֧ݧߧ BZ_BASE; ӧ ٧ 1..30 - ڧҧܧ ܧާڧݧڧ
+#define BZ_INDEX(n, oct) \
+    ((BZ_NOTE (n, oct) - BZ_BASE + 1) + 0 * sizeof (char[(BZ_NOTE (n, oct) >= BZ_BASE && BZ_NOTE (n, oct) - BZ_BASE < 30) ? 1 : -1]))
+
+#define BZ(n, oct, len) (uint8_t)((BZ_LEN_##len << 5) | BZ_INDEX (n, oct))
+#define BZ_REST(len) (uint8_t)(BZ_LEN_##len << 5)
+#define BZ_HEADER(unit_ms, volume) (uint8_t)(BZ_BASE), (uint8_t)(unit_ms), (uint8_t)((volume) * 128 / 100)
+#define BZ_END 0xFF
+#define BZ_VOL_CODE 0x1F  //  31 - ߧ ߧ: էѧݧ ҧѧۧ ܧӧѧاߧ
+#define BZ_VOL(volume) BZ_VOL_CODE, (uint8_t)((volume) * 128 / 100)
+
+extern void Buzzer_Play(const uint8_t *melody);
 
 // ԧ
-extern void melody_SuperMario(void);
-extern void melody_Tetris(void);
-extern void melody_StarWars(void);
-extern void melody_ImperialMarch(void);
-extern void melody_ZeldaSecret(void);
-extern void melody_Pacman(void);
+extern const uint8_t melody_SuperMario[];
+extern const uint8_t melody_Tetris[];
+extern const uint8_t melody_ImperialMarch[];
 
 // ѧ٧էߧڧߧ
-extern void melody_HappyBirthday(void);
-extern void melody_JingleBells(void);
-extern void melody_MerryChristmas(void);
+extern const uint8_t melody_HappyBirthday[];
+extern const uint8_t melody_JingleBells[];
 
 // ݧߧ
-extern void melody_PinkPanther(void);
-extern void melody_MissionImpossible(void);
-extern void melody_TakeOnMe(void);
-extern void melody_FurElise(void);
+extern const uint8_t melody_Nokia[];
+extern const uint8_t melody_FurElise[];
 
 // ݧѧڧܧ
-extern void melody_CanonInD(void);
-extern void melody_OdeToJoy(void);
-
+extern const uint8_t melody_OdeToJoy[];
 
 
+extern const uint8_t tune_ok[], tune_error[], tune_error_strong[], tune_warning[],
+    tune_warning_double[], tune_click[], tune_success_long[], tune_critical[],
+    tune_beepboop[], tune_access_denied[], tune_notify[], tune_ios_click[],
+    tune_android_notify[], tune_robot[], tune_microwave_done[], tune_winxp_msg[],
+    tune_startup[], tune_shutdown[], tune_charging[], tune_increment_max[],
+    tune_decrement_min[], tune_save[];
 
 // ---   ---
-extern void buzzer_ok(void);
-extern void buzzer_ok2(void);
-extern void buzzer_error(void);
-extern void buzzer_error_strong(void);
-extern void buzzer_warning(void);
-extern void buzzer_warning_double(void);
-extern void buzzer_click(void);
-extern void buzzer_success_long(void);
-extern void buzzer_critical(void);
-extern void buzzer_beepboop(void);
-extern void buzzer_access_denied(void);
-extern void buzzer_notify(void);
+#define buzzer_ok() Buzzer_Play (tune_ok)
+#define buzzer_error() Buzzer_Play (tune_error)
+#define buzzer_error_strong() Buzzer_Play (tune_error_strong)
+#define buzzer_warning() Buzzer_Play (tune_warning)
+#define buzzer_warning_double() Buzzer_Play (tune_warning_double)
+#define buzzer_click() Buzzer_Play (tune_click)
+#define buzzer_success_long() Buzzer_Play (tune_success_long)
+#define buzzer_critical() Buzzer_Play (tune_critical)
+#define buzzer_beepboop() Buzzer_Play (tune_beepboop)
+#define buzzer_access_denied() Buzzer_Play (tune_access_denied)
+#define buzzer_notify() Buzzer_Play (tune_notify)
 
 // ݧߧڧ֧ݧߧ ڧݧڧ٧ӧѧߧߧ:
-extern void buzzer_ios_click(void);
-extern void buzzer_android_notify(void);
-extern void buzzer_robot(void);
-extern void buzzer_microwave_done(void);
-extern void buzzer_winxp_msg(void);
+#define buzzer_ios_click() Buzzer_Play (tune_ios_click)
+#define buzzer_android_notify() Buzzer_Play (tune_android_notify)
+#define buzzer_robot() Buzzer_Play (tune_robot)
+#define buzzer_microwave_done() Buzzer_Play (tune_microwave_done)
+#define buzzer_winxp_msg() Buzzer_Play (tune_winxp_msg)
 
 
 // ---  ---
-extern void buzzer_startup(void);
-extern void buzzer_shutdown(void);
-extern void buzzer_charging(void);
-extern void buzzer_button_hold(void);
-
-
+#define buzzer_startup() Buzzer_Play (tune_startup)
+#define buzzer_shutdown() Buzzer_Play (tune_shutdown)
+#define buzzer_charging() Buzzer_Play (tune_charging)
 
 
-
-extern void beep_Increment_Max(void);
-extern void beep_Decrement_Min(void);
-extern void beep_Save(void);
+#define beep_Increment_Max() Buzzer_Play (tune_increment_max)
+#define beep_Decrement_Min() Buzzer_Play (tune_decrement_min)
+#define beep_Save() Buzzer_Play (tune_save)
 
 
 
+extern void tone1(uint16_t frequency, uint16_t duration_ms);
 extern void tone1_vol(uint16_t frequency, uint16_t duration_ms, uint8_t volume);
 
+// ---  (TIM2 CH1 + ֧֧է ߧ) ---
+extern void Buzzer_Init(void);
+extern void Buzzer_Tick(void);     //  SysTick_Handler, 1 ާ
+extern int  Buzzer_IsBusy(void);
+extern void Buzzer_Wait(void);
+extern void Buzzer_Stop(void);
+
 
 
 // ާѧߧ ߧӧߧ ԧݧѧߧ ٧ӧܧ (֧ߧߧ)
@@ -3,6 +3,8 @@
 void NMI_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void HardFault_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void SysTick_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void ADC1_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void TIM2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 
 /*********************************************************************
  * @fn      NMI_Handler
@@ -35,11 +37,36 @@ void HardFault_Handler(void)
   }
 }
 
-uint64_t millisec = 0;
-
 void SysTick_Handler(void)
 {
     //printf("Systick\r\n");
     millisec++;
     SysTick->SR = 0;
+    Buzzer_Tick();
+    Motor_Tick();
+}
+
+/*********************************************************************
+ * @fn      ADC1_IRQHandler
+ *
+ * @brief   Аналоговый сторож АЦП: ток выше порога
+ *
+ * @return  none
+ */
+void ADC1_IRQHandler(void)
+{
+    Current_Trip();
+}
+
+/*********************************************************************
+ * @fn      TIM2_IRQHandler
+ *
+ * @brief   TIM2 CH2: захват фронта тахо-датчика
+ *
+ * @return  none
+ */
+void TIM2_IRQHandler(void)
+{
+    if (TIM2->INTFR & TIM_CC2IF)
+        Tacho_Capture();
 }
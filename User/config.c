@@ -0,0 +1,491 @@
+#include <debug.h>
+
+/*
+ * Хранилище настроек - журнал во флеше (последний 1 КБ, Link.ld: FLASH 15K).
+ * Две половины по 512 Б (по 8 быстрых страниц 64 Б). Активная половина:
+ *   +0: CFG_MAGIC, +2: поколение - заголовок, пишется последним
+ *   +4...: записи по 4 байта { значение, id << 8 | crc8 }
+ * Сохранение дописывает запись в свободное место, стирания нет. Последняя
+ * запись с данным id - актуальная. Когда половина заполнена - уплотнение:
+ * последние значения всех id переносятся в другую половину, затем старая
+ * стирается. Стирание - раз в ~120 сохранений вместо каждого.
+ *
+ * Пакет (Cfg_Stage + Cfg_Flush): несколько параметров одной быстрой
+ * записью страницы 64 Б (FLASH_ProgramPage_Fast) со следующей границы
+ * страницы. Пропущенные слоты остаются пустыми - конец журнала ищется
+ * по последнему занятому слоту, а не по первому пустому. Записи пакета
+ * с другим начальным значением crc, последний слот страницы - слово
+ * подтверждения CFG_COMMIT, пишется после страницы. Без него записи
+ * пакета недействительны: пакет применяется целиком или никак.
+ *
+ * Потеря питания:
+ *   - недописанная запись не проходит crc и пропускается;
+ *   - пакет без слова подтверждения пропускается целиком;
+ *   - уплотнение без заголовка - новая половина не считается активной;
+ *   - с заголовком, но старая не стёрта - берётся более новое поколение;
+ *   - перенос старого формата идёт через черновик (Cfg_Import).
+ */
+
+#define CFG_HALF  512
+#define CFG_PAGE  64
+#define CFG_MAGIC 0xC0F1
+#define CFG_IMPORT 0xC0F2    // Черновик переноса старого формата (одна страница)
+#define CFG_LEGACY_PAGES 16  // Старый формат uEeprom: страница 64 Б на поле, { v, v }
+#define CFG_COMMIT 0xC0F3    // Слово подтверждения пакета (id 0xFF)
+#define CFG_BATCH (CFG_PAGE / 4 - 1)  // Записей в пакете - страница без слова подтверждения
+#define CFG_CRC_ONE   0xFF   // Начальное значение crc: одиночная запись
+#define CFG_CRC_BATCH 0x00   // Запись пакета
+
+#define CFG_HW(addr) (*(volatile uint16_t *)(addr))
+
+static uint32_t cfg_base = 0;  // Активная половина, 0 - Cfg_Init не вызывался
+static uint16_t cfg_tail = 4;  // Смещение за последней занятой записью
+static uint16_t cfg_gen = 0;
+
+static struct {
+    uint8_t id;
+    uint16_t value;
+} cfg_batch[CFG_BATCH];
+static uint8_t cfg_batch_n = 0;
+
+// CRC-8 (полином 0x07) по id и значению. Разное начальное значение -
+// разный crc для одних и тех же данных (разница постоянна и не 0)
+static uint8_t Cfg_Crc (uint8_t crc, uint8_t id, uint16_t value) {
+    uint8_t b[3] = {id, (uint8_t)value, (uint8_t)(value >> 8)};
+
+    for (uint8_t i = 0; i < 3; i++) {
+        crc ^= b[i];
+        for (uint8_t j = 0; j < 8; j++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+static uint8_t Cfg_IsHalf (uint32_t base) {
+    return CFG_HW (base) == CFG_MAGIC;
+}
+
+// Страница стёрта: все слова 0xFFFF. Недописанная или недостёртая при
+// отключении питания - не пустая
+static uint8_t Cfg_Blank (uint32_t page) {
+    for (uint32_t addr = page; addr < page + CFG_PAGE; addr += 4)
+        if (*(volatile uint32_t *)addr != 0xFFFFFFFF)
+            return 0;
+    return 1;
+}
+
+// Стереть страницы [from, to), кроме skip. Пустые не стираются: уплотнение
+// пишет в половину, стёртую прошлым уплотнением
+static void Cfg_ErasePages (uint32_t from, uint32_t to, uint32_t skip) {
+    FLASH_Unlock();
+    FLASH_Unlock_Fast();
+    for (uint32_t page = from; page < to; page += CFG_PAGE)
+        if (page != skip && !Cfg_Blank (page))
+            FLASH_ErasePage_Fast (page);
+    FLASH_Lock_Fast();
+    FLASH_Lock();
+}
+
+static void Cfg_Erase (uint32_t base) {
+    Cfg_ErasePages (base, base + CFG_HALF, 0);
+}
+
+static FLASH_Status Cfg_Program (uint32_t addr, uint16_t value) {
+    FLASH_Unlock();
+    FLASH_Status st = FLASH_ProgramHalfWord (addr, value);
+    FLASH_Lock();
+    return st;
+}
+
+// Значение, затем тег: запись действительна только целиком
+static FLASH_Status Cfg_Append (uint32_t addr, uint8_t id, uint16_t value) {
+    FLASH_Status st = Cfg_Program (addr, value);
+    if (st == FLASH_COMPLETE)
+        st = Cfg_Program (addr + 2, ((uint16_t)id << 8) | Cfg_Crc (CFG_CRC_ONE, id, value));
+    if (st == FLASH_COMPLETE && CFG_HW (addr) != value)
+        st = FLASH_ERROR_PG;
+    return st;
+}
+
+// Страница пакета подтверждена: в последнем слоте целое слово CFG_COMMIT
+static uint8_t Cfg_Committed (uint32_t page) {
+    uint32_t addr = page + CFG_PAGE - 4;
+
+    return CFG_HW (addr) == CFG_COMMIT &&
+           CFG_HW (addr + 2) == (0xFF00 | Cfg_Crc (CFG_CRC_ONE, 0xFF, CFG_COMMIT));
+}
+
+// Запись по адресу: 1 - действительна, id и значение в *id, *value.
+// Запись пакета - только если её страница подтверждена
+static uint8_t Cfg_Record (uint32_t addr, uint8_t *id, uint16_t *value) {
+    uint16_t tag = CFG_HW (addr + 2);
+
+    if (tag == 0xFFFF || (tag >> 8) == 0xFF)
+        return 0;  // Пустой слот или слово подтверждения
+    *id = tag >> 8;
+    *value = CFG_HW (addr);
+    if (Cfg_Crc (CFG_CRC_ONE, *id, *value) == (uint8_t)tag)
+        return 1;
+    return Cfg_Crc (CFG_CRC_BATCH, *id, *value) == (uint8_t)tag && Cfg_Committed (addr & ~(CFG_PAGE - 1));
+}
+
+// Заголовок последним: до него половина не активна
+static void Cfg_Commit (uint32_t base, uint16_t gen) {
+    Cfg_Program (base + 2, gen);
+    Cfg_Program (base, CFG_MAGIC);
+}
+
+// Запасной перенос без черновика: значения только в ОЗУ между стиранием и записью
+static void Cfg_ImportUnsafe (void) {
+    struct {
+        uint8_t id;
+        uint16_t value;
+    } rec[CFG_LEGACY_PAGES];
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < CFG_LEGACY_PAGES; i++) {
+        uint16_t a = CFG_HW (CFG_START + i * CFG_PAGE);
+        uint16_t b = CFG_HW (CFG_START + i * CFG_PAGE + 2);
+        if (a == b && a != 0xFFFF) {
+            rec[n].id = i;
+            rec[n].value = a;
+            n++;
+        }
+    }
+
+    Cfg_Erase (CFG_START);
+    Cfg_Erase (CFG_START + CFG_HALF);
+
+    cfg_base = CFG_START;
+    cfg_tail = 4;
+    cfg_gen = 0;
+    for (uint8_t i = 0; i < n; i++, cfg_tail += 4)
+        Cfg_Append (cfg_base + cfg_tail, rec[i].id, rec[i].value);
+    Cfg_Commit (cfg_base, cfg_gen);
+}
+
+// Перенос настроек старого формата (страница на поле) в журнал.
+// Старые значения лежат в тех же страницах, поэтому в два шага:
+//  1) значения - в страницу половины B без старых данных (черновик,
+//     CFG_IMPORT пишется последним), ничего старого не стирается;
+//  2) все страницы, кроме черновика, стираются, половина A пишется из
+//     черновика, заголовок, затем черновик стирается.
+// Питание пропало на шаге 2 - при загрузке шаг 2 повторяется по черновику
+static void Cfg_Import (void) {
+    uint32_t end = CFG_START + 2 * CFG_HALF;
+    uint32_t scratch = 0;
+
+    for (uint32_t page = CFG_START + CFG_HALF; page < end && !scratch; page += CFG_PAGE)
+        if (CFG_HW (page) == CFG_IMPORT)
+            scratch = page;
+
+    if (!scratch) {
+        // Шаг 1. Страница без значения старого формата: первое слово 0xFFFF
+        for (uint32_t page = CFG_START + CFG_HALF; page < end && !scratch; page += CFG_PAGE)
+            if (CFG_HW (page) == 0xFFFF && CFG_HW (page + 2) == 0xFFFF)
+                scratch = page;
+        if (!scratch) {
+            Cfg_ImportUnsafe();  // Все 16 страниц заняты - некуда
+            return;
+        }
+
+        Cfg_ErasePages (scratch, scratch + CFG_PAGE, 0);  // Мог остаться недописанный черновик
+        uint16_t pos = 4;
+        for (uint8_t i = 0; i < CFG_LEGACY_PAGES; i++) {
+            uint16_t a = CFG_HW (CFG_START + i * CFG_PAGE);
+            uint16_t b = CFG_HW (CFG_START + i * CFG_PAGE + 2);
+            if (a == b && a != 0xFFFF) {
+                Cfg_Append (scratch + pos, i, a);
+                pos += 4;  // Не больше 15: одна из 16 страниц - сам черновик
+            }
+        }
+        Cfg_Program (scratch, CFG_IMPORT);
+    }
+
+    // Шаг 2
+    Cfg_ErasePages (CFG_START, end, scratch);
+
+    cfg_base = CFG_START;
+    cfg_tail = 4;
+    cfg_gen = 0;
+    for (uint16_t off = 4; off < CFG_PAGE; off += 4) {
+        uint8_t id;
+        uint16_t value;
+        if (Cfg_Record (scratch + off, &id, &value)) {
+            Cfg_Append (cfg_base + cfg_tail, id, value);
+            cfg_tail += 4;
+        }
+    }
+    Cfg_Commit (cfg_base, cfg_gen);
+    Cfg_ErasePages (scratch, scratch + CFG_PAGE, 0);
+}
+
+// Последние значения всех id - в другую половину, старая стирается
+static void Cfg_Compact (void) {
+    uint32_t from = cfg_base;
+    uint32_t to = (from == CFG_START) ? CFG_START + CFG_HALF : CFG_START;
+    uint8_t seen[32] = {0};  // Битовая карта id 0..255
+    uint16_t pos = 4;
+
+    Cfg_Erase (to);
+
+    // С конца: первая встреченная запись id - последняя записанная
+    for (uint16_t off = cfg_tail; off > 4;) {
+        uint8_t id;
+        uint16_t value;
+
+        off -= 4;
+        if (!Cfg_Record (from + off, &id, &value) || (seen[id >> 3] & (1 << (id & 7))))
+            continue;
+        seen[id >> 3] |= 1 << (id & 7);
+        Cfg_Append (to + pos, id, value);
+        pos += 4;
+    }
+
+    Cfg_Commit (to, cfg_gen + 1);
+    Cfg_Erase (from);
+
+    cfg_base = to;
+    cfg_tail = pos;
+    cfg_gen++;
+}
+
+// Дописать запись в конец журнала, при заполненной половине - уплотнение
+static FLASH_Status Cfg_Put (uint8_t id, uint16_t value) {
+    if (cfg_tail >= CFG_HALF)
+        Cfg_Compact();
+    if (cfg_tail >= CFG_HALF)
+        return FLASH_ERROR_PG;  // Разных id больше, чем слотов в половине
+
+    FLASH_Status st = Cfg_Append (cfg_base + cfg_tail, id, value);
+    cfg_tail += 4;  // Слот занят и при ошибке
+    return st;
+}
+
+/*********************************************************************
+ * @fn      Cfg_Init
+ *
+ * @brief   Найти активную половину и конец журнала. При первом запуске
+ *          после прошивки - перенос настроек старого формата
+ *
+ * @return  none
+ */
+void Cfg_Init (void) {
+    uint32_t a = CFG_START, b = CFG_START + CFG_HALF;
+
+    if (Cfg_IsHalf (a) && Cfg_IsHalf (b)) {
+        // Уплотнение прервано после заголовка: новее - по поколению
+        if ((int16_t)(CFG_HW (b + 2) - CFG_HW (a + 2)) > 0) {
+            Cfg_Erase (a);
+            cfg_base = b;
+        } else {
+            Cfg_Erase (b);
+            cfg_base = a;
+        }
+    } else if (Cfg_IsHalf (a)) {
+        cfg_base = a;
+    } else if (Cfg_IsHalf (b)) {
+        cfg_base = b;
+    } else {
+        Cfg_Import();
+        return;
+    }
+
+    cfg_gen = CFG_HW (cfg_base + 2);
+
+    // Конец - за последним занятым слотом (занят - любой не 0xFFFF, в том
+    // числе недописанный). Пустые слоты перед пакетом пропускаются
+    cfg_tail = CFG_HALF;
+    while (cfg_tail > 4 && CFG_HW (cfg_base + cfg_tail - 4) == 0xFFFF && CFG_HW (cfg_base + cfg_tail - 2) == 0xFFFF)
+        cfg_tail -= 4;
+}
+
+/*********************************************************************
+ * @fn      Cfg_Read
+ *
+ * @brief   Последнее сохранённое значение параметра
+ *
+ * @param   id    - 0..254
+ *          value - куда положить значение
+ *
+ * @return  1 - найдено, 0 - не сохранялось
+ */
+uint8_t Cfg_Read (uint8_t id, uint16_t *value) {
+    uint8_t found = 0;
+
+    if (cfg_base == 0)
+        Cfg_Init();
+
+    for (uint16_t off = 4; off < cfg_tail; off += 4) {
+        uint8_t rid;
+        uint16_t v;
+        if (Cfg_Record (cfg_base + off, &rid, &v) && rid == id) {
+            *value = v;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+/*********************************************************************
+ * @fn      Cfg_Load
+ *
+ * @brief   Все сохранённые значения за один проход журнала
+ *
+ * @param   put - вызывается на каждую целую запись, по порядку записи:
+ *                последним для данного id приходит актуальное значение
+ *
+ * @return  none
+ */
+void Cfg_Load (void (*put) (uint8_t id, uint16_t value)) {
+    if (cfg_base == 0)
+        Cfg_Init();
+
+    for (uint16_t off = 4; off < cfg_tail; off += 4) {
+        uint8_t rid;
+        uint16_t v;
+        if (Cfg_Record (cfg_base + off, &rid, &v))
+            put (rid, v);
+    }
+}
+
+/*********************************************************************
+ * @fn      Cfg_Write
+ *
+ * @brief   Сохранить параметр: дописать запись в журнал
+ *
+ * @param   id    - 0..254 (0xFF зарезервирован: тег 0xFFFF - пустой слот)
+ *          value - значение
+ *
+ * @return  FLASH_COMPLETE - сохранено (или уже было таким)
+ *
+ * @note    Стирание (уплотнение) - только когда половина заполнена
+ */
+FLASH_Status Cfg_Write (uint8_t id, uint16_t value) {
+    uint16_t old;
+
+    if (id == 0xFF)
+        return FLASH_ERROR_PG;
+    if (Cfg_Read (id, &old) && old == value)
+        return FLASH_COMPLETE;
+    return Cfg_Put (id, value);
+}
+
+/*********************************************************************
+ * @fn      Cfg_Stage
+ *
+ * @brief   Добавить параметр в пакет (в ОЗУ, флеш не трогается)
+ *
+ * @param   id    - 0..254
+ *          value - значение
+ *
+ * @return  none
+ *
+ * @note    Повторный id заменяет значение. Пакет полон - сбрасывается сам
+ */
+void Cfg_Stage (uint8_t id, uint16_t value) {
+    if (id == 0xFF)
+        return;
+
+    for (uint8_t i = 0; i < cfg_batch_n; i++) {
+        if (cfg_batch[i].id == id) {
+            cfg_batch[i].value = value;
+            return;
+        }
+    }
+
+    if (cfg_batch_n == CFG_BATCH)
+        Cfg_Flush();
+    cfg_batch[cfg_batch_n].id = id;
+    cfg_batch[cfg_batch_n].value = value;
+    cfg_batch_n++;
+}
+
+/*********************************************************************
+ * @fn      Cfg_Flush
+ *
+ * @brief   Записать пакет: изменившиеся параметры - одной страницей
+ *
+ * @return  FLASH_COMPLETE - записано (или менять было нечего)
+ *
+ * @note    Одна разблокировка и одна быстрая запись страницы вместо
+ *          двух программирований полуслова на каждый параметр
+ */
+FLASH_Status Cfg_Flush (void) {
+    uint32_t buf[CFG_BATCH + 1];
+    uint16_t old[CFG_BATCH];
+    uint16_t found = 0;  // Биты: для cfg_batch[i] есть сохранённое значение
+    uint8_t n = 0;
+
+    if (cfg_batch_n == 0)
+        return FLASH_COMPLETE;
+    if (cfg_base == 0)
+        Cfg_Init();
+
+    // Текущие значения всех параметров пакета - за один проход журнала
+    for (uint16_t off = 4; off < cfg_tail; off += 4) {
+        uint8_t rid;
+        uint16_t v;
+        if (!Cfg_Record (cfg_base + off, &rid, &v))
+            continue;
+        for (uint8_t i = 0; i < cfg_batch_n; i++) {
+            if (cfg_batch[i].id == rid) {
+                old[i] = v;
+                found |= 1 << i;
+                break;
+            }
+        }
+    }
+
+    // Неизменившиеся не пишем
+    for (uint8_t i = 0; i < cfg_batch_n; i++) {
+        uint8_t id = cfg_batch[i].id;
+        uint16_t value = cfg_batch[i].value;
+        if ((found & (1 << i)) && old[i] == value)
+            continue;
+        buf[n++] = value | ((uint32_t)(((uint16_t)id << 8) | Cfg_Crc (CFG_CRC_BATCH, id, value)) << 16);
+    }
+    cfg_batch_n = 0;
+    if (n == 0)
+        return FLASH_COMPLETE;
+
+    // Одна запись - дешевле дописать, чем пропускать слоты до страницы
+    if (n == 1)
+        return Cfg_Put (buf[0] >> 24, (uint16_t)buf[0]);
+
+    uint16_t page = (cfg_tail + CFG_PAGE - 1) & ~(CFG_PAGE - 1);
+    if (page + CFG_PAGE > CFG_HALF) {
+        Cfg_Compact();
+        page = (cfg_tail + CFG_PAGE - 1) & ~(CFG_PAGE - 1);
+    }
+
+    if (page + CFG_PAGE > CFG_HALF) {
+        // Места на страницу нет и после уплотнения - по одной
+        FLASH_Status st = FLASH_COMPLETE;
+        for (uint8_t i = 0; i < n; i++)
+            if (Cfg_Put (buf[i] >> 24, (uint16_t)buf[i]) != FLASH_COMPLETE)
+                st = FLASH_ERROR_PG;
+        return st;
+    }
+
+    for (uint8_t i = n; i <= CFG_BATCH; i++)
+        buf[i] = 0xFFFFFFFF;  // Последний слот - под слово подтверждения
+
+    uint32_t addr = cfg_base + page;
+    FLASH_Unlock();
+    FLASH_Unlock_Fast();
+    FLASH_BufReset();
+    for (uint8_t i = 0; i <= CFG_BATCH; i++)
+        FLASH_BufLoad (addr + i * 4, buf[i]);
+    FLASH_ProgramPage_Fast (addr);
+    FLASH_Lock_Fast();
+    FLASH_Lock();
+
+    cfg_tail = page + CFG_PAGE;
+
+    // Подтверждение - только если страница записалась целиком
+    for (uint8_t i = 0; i < n; i++)
+        if (*(volatile uint32_t *)(addr + i * 4) != buf[i])
+            return FLASH_ERROR_PG;
+    return Cfg_Append (addr + CFG_PAGE - 4, 0xFF, CFG_COMMIT);
+}
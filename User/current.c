@@ -0,0 +1,238 @@
+#include <debug.h>
+
+/*
+ * Ток мотора: шунт на CURRENT_PIN (debug.h) - PA1 (AIN1) или PD2 (AIN3).
+ * На SOP-8 PA1 и PD6 (TX) - один вывод, поэтому с шунтом на PA1 printf
+ * отключён (DEBUG_NONE), иначе UART попадает в отсчёты и в сторож.
+ * Запуск АЦП - событие TIM1 CC1, которое Pwm ставит в середину импульса
+ * (CCR1 = CCR2 / 2), то есть отсчёт всегда в одной точке открытого ключа.
+ * DMA1 Channel1 по кругу пишет результаты в кольцо current_ring,
+ * процессор на каждый отсчёт не тратится.
+ *
+ * Защита: аналоговый сторож АЦП на том же канале. Отсчёт выше порога -
+ * прерывание ADC1 (высший приоритет вытеснения) сразу снимает MOE у TIM1,
+ * выход CH2N уходит в LOW за единицы мкс без главного цикла и Motor_Tick.
+ *
+ * Напряжение питания: внутренний источник Vrefint (~1.2 В) в injected-канале,
+ * программный запуск раз в период управления (Current_Vref).
+ */
+
+#if CURRENT_PIN == CURRENT_PA1
+#define CURRENT_PORT GPIOA
+#define CURRENT_GPIO GPIO_Pin_1
+#define CURRENT_PORT_RCC RCC_APB2Periph_GPIOA
+#elif CURRENT_PIN == CURRENT_PD2
+#define CURRENT_PORT GPIOD
+#define CURRENT_GPIO GPIO_Pin_2
+#define CURRENT_PORT_RCC RCC_APB2Periph_GPIOD
+#else
+#error "CURRENT_PIN: CURRENT_PA1 or CURRENT_PD2"
+#endif
+
+#define CURRENT_RING_LEN 16  // Степень двойки: среднее = сумма >> 4
+
+static volatile uint16_t current_ring[CURRENT_RING_LEN];
+static volatile uint8_t current_fault = 0;  // Защёлка срабатывания защиты
+static uint16_t current_vref = 0;           // Последний отсчёт Vrefint, 0 - ещё нет
+static uint8_t current_rd = 0;              // Позиция чтения для Current_Next
+
+/*********************************************************************
+ * @fn      Current_Init
+ *
+ * @brief   Вход шунта аналоговый, ADC1 по событию TIM1 CC1, DMA1 CH1 по кругу
+ *
+ * @return  none
+ */
+void Current_Init (void) {
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    ADC_InitTypeDef ADC_InitStructure = {0};
+    DMA_InitTypeDef DMA_InitStructure = {0};
+
+    RCC_APB2PeriphClockCmd (CURRENT_PORT_RCC | RCC_APB2Periph_ADC1, ENABLE);
+    RCC_AHBPeriphClockCmd (RCC_AHBPeriph_DMA1, ENABLE);
+    RCC_ADCCLKConfig (RCC_PCLK2_Div2);  // 4 МГц при HCLK 8 МГц
+
+    GPIO_InitStructure.GPIO_Pin = CURRENT_GPIO;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    GPIO_Init (CURRENT_PORT, &GPIO_InitStructure);
+
+    /* DMA: ADC1->RDATAR -> current_ring, по кругу */
+    DMA_DeInit (DMA1_Channel1);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC1->RDATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)current_ring;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = CURRENT_RING_LEN;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init (DMA1_Channel1, &DMA_InitStructure);
+    DMA_Cmd (DMA1_Channel1, ENABLE);
+
+    /* ADC: один канал, запуск от TIM1 CC1 */
+    ADC_DeInit (ADC1);
+    ADC_InitStructure.ADC_Mode = ADC_Mode_Independent;
+    ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+    ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+    ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T1_CC1;
+    ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
+    ADC_InitStructure.ADC_NbrOfChannel = 1;
+    ADC_Init (ADC1, &ADC_InitStructure);
+
+    // 30 + 11 тактов = ~10 мкс, укладывается в импульс на 5 кГц
+    ADC_RegularChannelConfig (ADC1, CURRENT_PIN, 1, ADC_SampleTime_30Cycles);
+
+    // Injected: Vrefint, запуск программный. Регулярный канал тока не трогает
+    ADC_InjectedSequencerLengthConfig (ADC1, 1);
+    ADC_InjectedChannelConfig (ADC1, ADC_Channel_Vrefint, 1, ADC_SampleTime_241Cycles);
+    ADC_ExternalTrigInjectedConvConfig (ADC1, ADC_ExternalTrigInjecConv_None);
+
+    ADC_DMACmd (ADC1, ENABLE);
+    ADC_Cmd (ADC1, ENABLE);
+
+    ADC_ResetCalibration (ADC1);
+    while (ADC_GetResetCalibrationStatus (ADC1))
+        ;
+    ADC_StartCalibration (ADC1);
+    while (ADC_GetCalibrationStatus (ADC1))
+        ;
+
+    ADC_ExternalTrigConvCmd (ADC1, ENABLE);
+
+    /* Прерывание сторожа - вытесняет SysTick (у него приоритет вытеснения 1) */
+    NVIC_InitStructure.NVIC_IRQChannel = ADC_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init (&NVIC_InitStructure);
+}
+
+/*********************************************************************
+ * @fn      Current_SetLimit
+ *
+ * @brief   Порог аппаратной защиты по току (аналоговый сторож)
+ *
+ * @param   raw - порог в единицах АЦП 1..1023, 0 - защита выключена
+ *
+ * @return  none
+ */
+void Current_SetLimit (uint16_t raw) {
+    ADC_ITConfig (ADC1, ADC_IT_AWD, DISABLE);
+    if (raw == 0) {
+        ADC_AnalogWatchdogCmd (ADC1, ADC_AnalogWatchdog_None);
+        return;
+    }
+
+    ADC_AnalogWatchdogThresholdsConfig (ADC1, raw, 0);
+    ADC_AnalogWatchdogSingleChannelConfig (ADC1, CURRENT_PIN);
+    ADC_AnalogWatchdogCmd (ADC1, ADC_AnalogWatchdog_SingleRegEnable);
+    ADC_ClearFlag (ADC1, ADC_FLAG_AWD);
+    ADC_ITConfig (ADC1, ADC_IT_AWD, ENABLE);
+}
+
+/*********************************************************************
+ * @fn      Current_Trip
+ *
+ * @brief   Срабатывание защиты. Вызывается из ADC1_IRQHandler
+ *
+ * @return  none
+ */
+void Current_Trip (void) {
+    TIM1->BDTR &= ~TIM_MOE;  // Первым делом - выход в LOW
+    current_fault = 1;
+    ADC_ClearFlag (ADC1, ADC_FLAG_AWD);
+}
+
+/*********************************************************************
+ * @fn      Current_IsFault
+ *
+ * @brief   Защёлка: было ли срабатывание с последнего Current_ClearFault
+ *
+ * @return  1 - было
+ */
+uint8_t Current_IsFault (void) {
+    return current_fault;
+}
+
+void Current_ClearFault (void) {
+    current_fault = 0;
+}
+
+/*********************************************************************
+ * @fn      Current_Last
+ *
+ * @brief   Последний отсчёт (позиция записи берётся из счётчика DMA)
+ *
+ * @return  0..1023 (сырые единицы АЦП)
+ */
+uint16_t Current_Last (void) {
+    uint8_t next = CURRENT_RING_LEN - DMA1_Channel1->CNTR;  // Куда DMA пишет следующий
+
+    return current_ring[(uint8_t)(next - 1) & (CURRENT_RING_LEN - 1)];
+}
+
+/*********************************************************************
+ * @fn      Current_Next
+ *
+ * @brief   Следующий непрочитанный отсчёт потока (по одному, по порядку)
+ *
+ * @param   sample - куда положить отсчёт
+ *
+ * @return  1 - отсчёт есть, 0 - новых нет
+ *
+ * @note    Читать чаще, чем DMA обходит кольцо (16 периодов ШИМ),
+ *          иначе часть отсчётов будет потеряна
+ */
+uint8_t Current_Next (uint16_t *sample) {
+    uint8_t wr = (CURRENT_RING_LEN - DMA1_Channel1->CNTR) & (CURRENT_RING_LEN - 1);
+
+    if (current_rd == wr)
+        return 0;
+
+    *sample = current_ring[current_rd];
+    current_rd = (current_rd + 1) & (CURRENT_RING_LEN - 1);
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      Current_Vref
+ *
+ * @brief   Отсчёт Vrefint: забрать готовый результат и запустить следующий
+ *
+ * @return  0..1023, 0 - измерений ещё не было. VDD = 1.2 В * 1023 / отсчёт
+ *
+ * @note    Вызывать периодически (раз в 1 мс): преобразование идёт ~65 мкс
+ *          в фоне, ждать его не нужно
+ */
+uint16_t Current_Vref (void) {
+    if (ADC_GetFlagStatus (ADC1, ADC_FLAG_JEOC)) {
+        current_vref = ADC_GetInjectedConversionValue (ADC1, ADC_InjectedChannel_1);
+        ADC_ClearFlag (ADC1, ADC_FLAG_JEOC);
+    }
+    ADC_SoftwareStartInjectedConvCmd (ADC1, ENABLE);
+
+    return current_vref;
+}
+
+/*********************************************************************
+ * @fn      Current_Get
+ *
+ * @brief   Среднее по кольцу последних отсчётов
+ *
+ * @return  0..1023 (сырые единицы АЦП)
+ *
+ * @note    При заполнении 0% запусков нет - значение остаётся последним
+ *          измеренным
+ */
+uint16_t Current_Get (void) {
+    uint16_t sum = 0;  // 16 * 1023 < 65536
+
+    for (uint8_t i = 0; i < CURRENT_RING_LEN; i++)
+        sum += current_ring[i];
+
+    return sum >> 4;
+}
@@ -37,268 +37,178 @@
 #define EEPROM_LOG_DEBUG(fmt, ...) ((void)0)
 #endif
 
-/* EEPROM start address in Flash memory */
-#define EEPROM_START_ADDRESS ((uint32_t)0x08003C00) /* EEPROM emulation start: after 2KB used Flash */
-
-class uEeprom {
+/*
+ * Значения хранятся журналом во флеше (config.c): сохранение дописывает
+ * запись { значение, index, crc }, страница стирается только при уплотнении.
+ * id параметра в журнале - 0..254
+ */
+#define EEPROM_START_ADDRESS CFG_START
+
+/*
+ * Параметр настройки - тип, а не объект: id в журнале, диапазон и значение
+ * по умолчанию - параметры шаблона и сворачиваются в константы. В ОЗУ -
+ * только само значение (2 байта), оно сразу равно Def (.data), так что
+ * инициализации по полям при старте нет: uConfig::load() - один проход
+ * журнала (Cfg_Load).
+ */
+template <uint8_t Id, uint16_t Min, uint16_t Max, uint16_t Def>
+class uParam {
   public:
-    // Default constructor - creates empty object
-    uEeprom()
-        : index (0), min (0), max (0), define (0), title (nullptr), value (0), initialized (false) {
-        // No actions - empty object
-    }
+    static_assert (Id != 0xFF, "id 0xFF reserved (empty journal slot)");
+    static_assert (Min <= Def && Def <= Max, "default out of range");
 
-    uint16_t index;
-    uint16_t min;
-    uint16_t max;
-    uint16_t define;
-    const char *title;
-    bool initialized;
-
-    void set (uint16_t i) {
-        if (!initialized) {
-            EEPROM_LOG_ERROR ("ERR: set() before init()!");
-            return;
-        }
+    static constexpr uint8_t id = Id;
+    static constexpr uint16_t min = Min;
+    static constexpr uint16_t max = Max;
+    static constexpr uint16_t define = Def;
 
-        if (i < min || i > max) {
-            EEPROM_LOG_WARN (FG (82) "\"%s\"" RESET1 ": Val " FG (196) "%u" RESET1
-                                                                            " out of range [%u..%u], clamped",
-                             title, i, min, max);
-            i = (i < min) ? min : max;
-        }
-
-        EEPROM_LOG (FG (82) "\"%s\"" RESET1 ": Set: " FG (226) "idx=%u" RESET1
-                                                                              ", old=%u → " FG (82) "new=%u" RESET1,
-                    title, index, value, i);
-        value = i;
+    static uint16_t get (void) {
+        return value;
     }
 
-    uint16_t get (void) {
-        if (!initialized) {
-            EEPROM_LOG_ERROR ("ERR: get() before init()!");
-            return 0;
+    static void set (uint16_t i) {
+        if (i < Min || i > Max) {
+            EEPROM_LOG_WARN (FG (226) "idx=%u" RESET1 ": Val " FG (196) "%u" RESET1 " out of range [%u..%u], clamped",
+                             Id, i, Min, Max);
+            i = (i < Min) ? Min : Max;
         }
 
-        EEPROM_LOG (FG (82) "\"%s\"" RESET1 ": Get: " FG (226) "idx=%u" RESET1
-                                                                           ", val=" FG (82) "%u" RESET1,
-                    title, index, value);
-        return value;
+        EEPROM_LOG ("Set: " FG (226) "idx=%u" RESET1 ", old=%u → " FG (82) "new=%u" RESET1, Id, value, i);
+        value = i;
     }
 
-    FLASH_Status save() {
-        if (!initialized) {
-            EEPROM_LOG_ERROR ("ERR: save() before init()!");
-            return FLASH_ERROR_PG;
+    static FLASH_Status save (void) {
+        // Дописать запись; то же значение - без записи
+        FLASH_Status res = Cfg_Write (Id, value);
+        if (res == FLASH_COMPLETE) {
+            EEPROM_LOG_OK ("Save " FG (226) "idx=%u" RESET1 ", val=" FG (82) "%u" RESET1, Id, value);
+        } else {
+            EEPROM_LOG_ERROR ("Save " FG (226) "idx=%u" RESET1 " err! St=%d", Id, res);
         }
+        return res;
+    }
 
-        uint32_t address = EEPROM_START_ADDRESS + (index * 64);
+    // Добавить в пакет; запись во флеш - Cfg_Flush() для всех сразу
+    static void stage (void) {
+        Cfg_Stage (Id, value);
+    }
 
-        EEPROM_LOG (BOLD FG (82) "\"%s\"" RESET1 BOLD ": Save to Flash" RESET1, title);
-        EEPROM_LOG ("  " FG (226) "idx=%u" RESET1 ", adr=" FG (141) "0x%08X" RESET1
-                                                                 ", val=" FG (82) "%u:0x%04X" RESET1,
-                    index, address, value, value);
+    // Значение из журнала: вне диапазона (диапазон поменялся в прошивке) - к границе
+    static void load (uint16_t v) {
+        value = (v < Min) ? Min : (v > Max) ? Max : v;
+    }
 
-        uint16_t currentValue = *(volatile uint16_t *)address;
-        if (currentValue == value) {
-            EEPROM_LOG_OK (FG (82) "\"%s\"" RESET1 ": Already saved (0x%04X), skip",
-                           title, currentValue);
-            return FLASH_COMPLETE;
-        }
+    static uint16_t value;
+};
 
-        EEPROM_LOG_INFO (FG (82) "\"%s\"" RESET1 ": Unlock Flash...", title);
-        FLASH_Unlock();
-        FLASH_Unlock_Fast();
-
-        EEPROM_LOG_INFO (FG (82) "\"%s\"" RESET1 ": Erase 64B @ " FG (141) "0x%08X" RESET1, title, address);
-        FLASH_ErasePage_Fast (address);
-        
-        EEPROM_LOG_INFO (FG (82) "\"%s\"" RESET1 ": Lock fast mode", title);
-        FLASH_Lock_Fast();
-        FLASH_Lock();
-        
-        // Verify erase
-        EEPROM_LOG_INFO ("Verify erase (64B)...");
-        bool eraseOk = true;
-        for (uint32_t i = 0; i < 32; i++) {
-            uint16_t readVal = *(volatile uint16_t *)(address + (i * 2));
-            if (readVal != 0xFFFF) {
-                EEPROM_LOG_ERROR ("Erase err %08X:0x%04X", address + (i * 2), readVal);
-                eraseOk = false;
-            }
-        }
-        
-        if (!eraseOk) {
-            EEPROM_LOG_ERROR (FG (82) "\"%s\"" RESET1 ": Block not erased!", title);
-            return FLASH_ERROR_PG;
-        }
-        
-        EEPROM_LOG_OK ("Block erased (all 64B=0xFFFF)");
-
-        // Write data
-        EEPROM_LOG_INFO (FG (82) "\"%s\"" RESET1 ": Write data...", title);
-        FLASH_Unlock();
-        
-        FLASH_Status res = FLASH_ProgramHalfWord (address, value);
-        if (res != FLASH_COMPLETE) {
-            EEPROM_LOG_ERROR (FG (82) "\"%s\"" RESET1 ": Write word1 err! St=%d", title, res);
-            FLASH_Lock();
-            return res;
-        }
+template <uint8_t Id, uint16_t Min, uint16_t Max, uint16_t Def>
+uint16_t uParam<Id, Min, Max, Def>::value = Def;
 
-        res = FLASH_ProgramHalfWord (address + 2, value);
-        if (res != FLASH_COMPLETE) {
-            EEPROM_LOG_ERROR (FG (82) "\"%s\"" RESET1 ": Write word2 err! St=%d", title, res);
-        }
+/*
+ * Для кода, общего для нескольких параметров (uniScreen): адрес значения
+ * и диапазон. uEeprom::of<P>() - константа, в ОЗУ не хранится
+ */
+struct uEeprom {
+    uint16_t *value;
+    uint16_t min;
+    uint16_t max;
 
-        FLASH_Lock();
+    template <class P>
+    static constexpr uEeprom of (void) {
+        return uEeprom{&P::value, P::min, P::max};
+    }
 
-        // Verify write
-        uint16_t verify1 = *(volatile uint16_t *)address;
-        uint16_t verify2 = *(volatile uint16_t *)(address + 2);
-        if (verify1 == value && verify2 == value) {
-            EEPROM_LOG_OK (FG (82) "\"%s\"" RESET1 ": Save OK, w1=0x%04X w2=0x%04X",
-                           title, verify1, verify2);
-        } else {
-            EEPROM_LOG_ERROR (FG (82) "\"%s\"" RESET1 ": Verify err! Exp=0x%04X, rd: w1=0x%04X w2=0x%04X",
-                              title, value, verify1, verify2);
-        }
+    uint16_t get (void) const {
+        return *value;
+    }
 
-        return res;
+    void set (uint16_t i) const {
+        *value = (i < min) ? min : (i > max) ? max : i;
     }
+};
 
-    int16_t readEEPROM (void) {
-        if (!initialized) {
-            EEPROM_LOG_ERROR ("ERR: readEEPROM() before init()!");
-            return 0;
-        }
+/*
+ * Реестр параметров: uConfig<P...>::unique() - нет ли двух параметров с
+ * одним id (проверяется static_assert при компиляции), load() и stage() -
+ * для всех сразу
+ */
+template <class... P>
+struct uConfig;
+
+template <>
+struct uConfig<> {
+    static constexpr bool has (uint8_t) {
+        return false;
+    }
+    static constexpr bool unique (void) {
+        return true;
+    }
+    static void put (uint8_t, uint16_t) {}
+    static void stage (void) {}
+};
 
-        uint32_t address = EEPROM_START_ADDRESS + (index * 64);
-        int16_t val = *(volatile uint16_t *)address;
-        EEPROM_LOG (FG (82) "\"%s\"" RESET1 ": Direct read: " FG (226) "idx=%u" RESET1
-                                                                                ", adr=" FG (141) "0x%08X" RESET1 ", val=" FG (82) "%d" RESET1,
-                    title, index, address, val);
-        return val;
+template <class P, class... R>
+struct uConfig<P, R...> {
+    static constexpr bool has (uint8_t id) {
+        return P::id == id || uConfig<R...>::has (id);
+    }
+    static constexpr bool unique (void) {
+        return !uConfig<R...>::has (P::id) && uConfig<R...>::unique();
     }
 
-    // MAIN METHOD - accepts all parameters and initializes object
-    void init (uint16_t _index, uint16_t _min, uint16_t _max, uint16_t _define, const char *_title) {
-        // Save parameters
-        index = _index;
-        min = _min;
-        max = _max;
-        define = _define;
-        title = _title;
-
-        uint32_t address = EEPROM_START_ADDRESS + (index * 64);
-
-        EEPROM_LOG_INFO (BOLD "╔════════════════════════════════════════╗" RESET1);
-        EEPROM_LOG_INFO (BOLD "║ Init EEPROM: " FG (82) "%-17s" RESET1 "         ║", title);
-        EEPROM_LOG_INFO (BOLD "╠════════════════════════════════════════╣" RESET1);
-        EEPROM_LOG_INFO ("║ " FG (226) "Idx: %3u" RESET1 "                               ║", index);
-        EEPROM_LOG_INFO ("║ " FG (141) "Adr: 0x%08X" RESET1 "                        ║", address);
-        EEPROM_LOG_INFO ("║ Range: [%3u .. %4u]                   ║", min, max);
-        EEPROM_LOG_INFO ("║ " FG (82) "Def: %-3u" RESET1 "                               ║", define);
-        EEPROM_LOG_INFO (BOLD "╚════════════════════════════════════════╝" RESET1);
-
-        uint16_t a = (*(volatile uint16_t *)address);
-        uint16_t b = (*(volatile uint16_t *)(address + 2));
-
-        EEPROM_LOG ("Read from Flash: w1=" FG (141) "0x%04X" RESET1 " (%u), w2=" FG (141) "0x%04X" RESET1 " (%u)",
-                    a, a, b, b);
-
-        if ((a != b) || (a == 0xFFFF) || (b == 0xFFFF)) {
-            EEPROM_LOG_WARN ("Invalid or empty data detected!");
-
-            if (a != b) {
-                EEPROM_LOG_WARN ("  Reason: " FG (196) "mismatch" RESET1 " (w1=0x%04X != w2=0x%04X)", a, b);
-            }
-            if (a == 0xFFFF) {
-                EEPROM_LOG_WARN ("  Reason: " FG (196) "w1=0xFFFF" RESET1 " (unprogrammed)");
-            }
-            if (b == 0xFFFF) {
-                EEPROM_LOG_WARN ("  Reason: " FG (196) "w2=0xFFFF" RESET1 " (unprogrammed)");
-            }
-
-            EEPROM_LOG_INFO ("Init with default: " FG (82) "%u" RESET1, define);
-
-            EEPROM_LOG_INFO ("Unlock Flash...");
-            FLASH_Unlock();
-            
-            EEPROM_LOG_INFO ("Unlock fast mode...");
-            FLASH_Unlock_Fast();
-
-            EEPROM_LOG_INFO ("Erase 64B block @ " FG (141) "0x%08X" RESET1, address);
-            FLASH_ErasePage_Fast (address);
-            
-            EEPROM_LOG_INFO ("Lock fast mode...");
-            FLASH_Lock_Fast();
-            
-            EEPROM_LOG_INFO ("Lock Flash...");
-            FLASH_Lock();
-
-            // Verify erase
-            EEPROM_LOG_DEBUG ("Verify erase (64B)...");
-            bool eraseOk = true;
-            for (uint32_t i = 0; i < 32; i++) {
-                uint16_t readVal = *(volatile uint16_t *)(address + (i * 2));
-                if (readVal != 0xFFFF) {
-                    EEPROM_LOG_ERROR ("Erase err %08X:0x%04X", address + (i * 2), readVal);
-                    eraseOk = false;
-                }
-            }
-            
-            if (!eraseOk) {
-                EEPROM_LOG_ERROR ("Block not erased! Init aborted.");
-                initialized = false;
-                return;
-            }
-            
-            EEPROM_LOG_OK ("Block erased");
-
-            // Write default value
-            EEPROM_LOG_INFO ("Unlock Flash for write...");
-            FLASH_Unlock();
-            
-            EEPROM_LOG_INFO ("Write w1 (def=" FG (82) "%u" RESET1 ")...", define);
-            FLASH_Status st1 = FLASH_ProgramHalfWord (address, define);
-            if (st1 != FLASH_COMPLETE) {
-                EEPROM_LOG_ERROR ("Write w1 err! St=%d", st1);
-            }
-            
-            EEPROM_LOG_INFO ("Write w2...");
-            FLASH_Status st2 = FLASH_ProgramHalfWord (address + 2, define);
-            if (st2 != FLASH_COMPLETE) {
-                EEPROM_LOG_ERROR ("Write w2 err! St=%d", st2);
-            }
-
-            EEPROM_LOG_INFO ("Lock Flash...");
-            FLASH_Lock();
-
-            // Verify write
-            uint16_t verify1 = *(volatile uint16_t *)address;
-            uint16_t verify2 = *(volatile uint16_t *)(address + 2);
-            EEPROM_LOG_DEBUG ("Verify: w1=0x%04X w2=0x%04X", verify1, verify2);
-
-            if (verify1 == define && verify2 == define) {
-                value = define;
-                EEPROM_LOG_OK ("Init done, val=" FG (82) "%u" RESET1, value);
-            } else {
-                EEPROM_LOG_ERROR ("Verify err! Exp=0x%04X, rd: w1=0x%04X w2=0x%04X",
-                                 define, verify1, verify2);
-                value = define;  // Set default anyway
-            }
-        } else {
-            // Data is valid - load it
-            value = a;
-            EEPROM_LOG_OK ("Init OK, loaded val=" FG (82) "%u" RESET1, value);
-        }
+    // Запись журнала -> параметр с этим id (цепочка сравнений с константами)
+    static void put (uint8_t id, uint16_t v) {
+        if (id == P::id)
+            P::load (v);
+        else
+            uConfig<R...>::put (id, v);
+    }
 
-        initialized = true;
+    static void load (void) {
+        Cfg_Load (put);
     }
 
-  private:
-    int16_t value;
+    static void stage (void) {
+        P::stage();
+        uConfig<R...>::stage();
+    }
 };
 
+/* Настройки устройства ------------------------------------------------------*/
+// Без тахо обороты меряются по пульсациям - выше RIPPLE_RPM_MAX они не видны
+#if MOTOR_USE_TACHO
+#define MOTOR_RPM_MAX 20000
+#else
+#define MOTOR_RPM_MAX RIPPLE_RPM_MAX
+#endif
+
+typedef uParam<0, 0, 100, 50> CfgPower;            // Мощность мотора, %
+typedef uParam<1, 0, 1, 0> CfgBoostEnable;         // Буст при запуске
+typedef uParam<2, 0, 100, 10> CfgBoostPower;       // Добавка мощности в буст, %
+typedef uParam<3, 0, 1000, 100> CfgBoostTime;      // Время буста в ms
+typedef uParam<4, 0, 1, 0> CfgLoopMode;            // 0 - разомкнутый (мощность в %), 1 - по оборотам (ПИ)
+typedef uParam<5, 0, 32767, 8192> CfgPiKp;         // Q15
+typedef uParam<6, 0, 32767, 64> CfgPiKi;           // Q15
+typedef uParam<7, 1000, MOTOR_RPM_MAX, 6000> CfgMaxRpm;  // Обороты при мощности 100% в режиме по оборотам
+typedef uParam<8, 0, 5000, 300> CfgRampTime;       // Плавный разгон/останов, мс (0 - выкл)
+typedef uParam<9, 0, 2, 1> CfgRampShape;           // 0 - линейно, 1 - S-кривая, 2 - экспонента
+
+typedef uConfig<CfgPower, CfgBoostEnable, CfgBoostPower, CfgBoostTime, CfgLoopMode, CfgPiKp, CfgPiKi, CfgMaxRpm,
+                CfgRampTime, CfgRampShape>
+    Config;
+
+static_assert (Config::unique(), "config: two parameters share one id");
+
+// Прежние имена: пустые константы, вызовы - статические методы типа
+constexpr CfgPower eeprom_power{};
+constexpr CfgBoostEnable eeprom_boostEnable{};
+constexpr CfgBoostPower eeprom_boostPower{};
+constexpr CfgBoostTime eeprom_boostTime{};
+constexpr CfgLoopMode eeprom_loopMode{};
+constexpr CfgPiKp eeprom_piKp{};
+constexpr CfgPiKi eeprom_piKi{};
+constexpr CfgMaxRpm eeprom_maxRpm{};
+constexpr CfgRampTime eeprom_rampTime{};
+constexpr CfgRampShape eeprom_rampShape{};
+
 #endif /* __cplusplus */
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * EEPROM Emulation for CH32V003
+ * Based on ST AN3969 algorithm
+ *
+ * Two flash pages, records { data, tag } appended to the valid page,
+ * tag = virtual address (0..254) | CRC-8 of address and data << 8.
+ * When the page is full the latest value of every address is transferred
+ * to the other page. Records cut by power loss fail the CRC and are skipped.
+ *
+ * Not part of the firmware build: settings are stored by config.c.
+ * Checked on the host by test/eeprom_test.c, which also compares page
+ * scan and RAM index read cost.
+ */
+
+#ifndef __EEPROM_CH32V_H
+#define __EEPROM_CH32V_H
+
+#include <debug.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Debug Configuration ------------------------------------------------------*/
+#ifndef EEPROM_DEBUG
+#define EEPROM_DEBUG 0  // 0 = disable, 1 = enable debug messages
+#endif
+
+#ifndef EEPROM_LOG
+#if EEPROM_DEBUG
+#define EEPROM_LOG(fmt, ...) printf ("[EE] " fmt "\r\n", ##__VA_ARGS__)
+#else
+#define EEPROM_LOG(fmt, ...) ((void)0)
+#endif
+#endif
+
+/* Page status (first halfword of page) */
+#define EEPROM_ERASED       ((uint16_t)0xFFFF)
+#define EEPROM_RECEIVE_DATA ((uint16_t)0xEEEE)
+#define EEPROM_VALID_PAGE   ((uint16_t)0x0000)
+
+/* Return codes */
+#define EEPROM_OK            ((uint16_t)0x00)
+#define EEPROM_BAD_FLASH     ((uint16_t)0x01)
+#define EEPROM_FLASH_ERROR   ((uint16_t)0x02)
+#define EEPROM_BAD_ADDRESS   ((uint16_t)0x03)
+#define EEPROM_NO_VALID_PAGE ((uint16_t)0x04)
+#define EEPROM_OUT_SIZE      ((uint16_t)0x05)
+#define EEPROM_NOT_INIT      ((uint16_t)0x06)
+#define EEPROM_SAME_VALUE    ((uint16_t)0x07)
+
+/* Value returned by EEPROM_Read for a missing address */
+#define EEPROM_DEFAULT_DATA ((uint16_t)0xFFFF)
+
+/* RAM index: virtual addresses 0..EEPROM_INDEX_SIZE-1 map directly to the
+ * slot of their latest record (1 byte each). Higher addresses are still
+ * found by scanning the page */
+#ifndef EEPROM_INDEX_SIZE
+#define EEPROM_INDEX_SIZE 32
+#endif
+
+typedef struct {
+    uint32_t PageBase0;  // Page 0 address
+    uint32_t PageBase1;  // Page 1 address
+    uint32_t PageSize;   // Page size, bytes (up to 1 KB: slot numbers fit a byte)
+    uint16_t Status;     // EEPROM_NOT_INIT before EEPROM_Init
+
+    /* Filled by EEPROM_Init, kept up to date by writes */
+    uint32_t Active;                    // Valid page, 0 = index not built
+    uint16_t Free;                      // First erased slot (1 slot = 4 bytes)
+    uint8_t Spill;                      // Records with address >= EEPROM_INDEX_SIZE
+    uint8_t Index[EEPROM_INDEX_SIZE];   // Slot of latest record, 0 = none
+} EEPROM_HandleTypeDef;
+
+/* Use EEPROM_HANDLE_INIT to set Status = EEPROM_NOT_INIT and clear the index */
+#define EEPROM_HANDLE_INIT(base0, base1, size) \
+    { (base0), (base1), (size), EEPROM_NOT_INIT, 0, 0, 0, {0} }
+
+uint16_t EEPROM_Init(EEPROM_HandleTypeDef *heeprom);
+uint16_t EEPROM_Format(EEPROM_HandleTypeDef *heeprom);
+uint16_t EEPROM_Read(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t *Data);
+uint16_t EEPROM_Write(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t Data);
+uint16_t EEPROM_Update(EEPROM_HandleTypeDef *heeprom, uint16_t Address, uint16_t Data);
+uint16_t EEPROM_Count(EEPROM_HandleTypeDef *heeprom, uint16_t *Count);
+uint16_t EEPROM_MaxCount(EEPROM_HandleTypeDef *heeprom);
+uint16_t EEPROM_Erases(EEPROM_HandleTypeDef *heeprom, uint16_t *Erases);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EEPROM_CH32V_H */
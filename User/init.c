@@ -27,11 +27,8 @@ void init (void) {
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
     GPIO_Init (GPIOC, &GPIO_InitStructure);
 
-    // BUZZER
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
-    GPIO_Init (GPIOC, &GPIO_InitStructure);
+    // BUZZER (PC1 = TIM2_CH1)
+    Buzzer_Init();
 
     // KEY
     GPIO_InitStructure.GPIO_Pin = GPIO_Pin_4;
@@ -39,7 +36,6 @@ void init (void) {
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
     GPIO_Init (GPIOC, &GPIO_InitStructure);
 
-    // BUZZER_ON;
     LED_ON;
     Delay_Ms (5);
     LED_OFF;
@@ -14,10 +14,12 @@
 // │ VDD    │ VDD      │ PC1      │ Buzzer (зуммер) │
 // └────────┴──────────┴──────────┴─────────────────┘
 //
+// Вывод 1 - это и PD6 (TX), и PA1 (шунт тока): при CURRENT_PIN = CURRENT_PA1
+// UART отключён (debug.h), printf ничего не выводит
+//
 
 #include <debug.h>
 #include "uButton.h"
-#include "pwm.hpp"
 
 #include "eeprom.hpp"
 
@@ -25,12 +27,8 @@
 // EEPROM_HandleTypeDef heeprom = EEPROM_HANDLE_DEFAULT();
 
 uButton b;
-Pwm pwm;
 
-uEeprom eeprom_power;        // Мощность мотора
-uEeprom eeprom_boostEnable;  // Настройка того что будет использоваться буст
-uEeprom eeprom_boostPower;   //
-uEeprom eeprom_boostTime;    // Время буста в ms
+// Настройки - в eeprom.hpp (Config): id, диапазоны и значения по умолчанию
 
 // uint16_t configCurrentPower = 10;  // Текущая мощность 0..100
 
@@ -89,19 +87,19 @@ void EXTI_INT_INIT (void) {
     EXTI_Init (&EXTI_InitStructure);
 }
 
+// Прочитать все настройки: один проход журнала, чего нет - остаётся по умолчанию
 void userEEPROM() {
+    printf (".READ CONFIG\n");
+    Config::load();
+}
 
-    printf (".READ CONFIG Power\n");
-    eeprom_power.init (0, 0, 100, 50, (char *)"Power");
-
-    printf (".READ CONFIG Boost Enable\n");
-    eeprom_boostEnable.init (1, 0, 1, 0, (char *)"Boost Enable");
-
-    printf (".READ CONFIG Boost Power\n");
-    eeprom_boostPower.init (2, 0, 100, 10, (char *)"Boost Power");
+// Сохранить все настройки: изменившиеся пишутся одной страницей флеша
+void userEEPROMSave (void) {
+    Config::stage();
 
-    printf (".READ CONFIG Boost Time\n");
-    eeprom_boostTime.init (3, 0, 1000, 100, (char *)"Boost Time");
+    FLASH_Status st = Cfg_Flush();
+    if (st != FLASH_COMPLETE)
+        printf ("CONFIG save error %d\r\n", st);
 }
 
 int main (void) {
@@ -131,6 +129,10 @@ int main (void) {
     printf ("CONFIG Boost Enable : %d\r\n", eeprom_boostEnable.get());
     printf ("CONFIG Boost Power   : %d %%\r\n", eeprom_boostPower.get());
     printf ("CONFIG Boost Time   : %d ms\r\n", eeprom_boostTime.get());
+    printf ("CONFIG Loop Mode    : %d\r\n", eeprom_loopMode.get());
+    printf ("CONFIG PI Kp/Ki     : %d / %d\r\n", eeprom_piKp.get(), eeprom_piKi.get());
+    printf ("CONFIG Max RPM      : %d\r\n", eeprom_maxRpm.get());
+    printf ("CONFIG Ramp         : %d ms, shape %d\r\n", eeprom_rampTime.get(), eeprom_rampShape.get());
 
     printf ("-------------------------\r\n");
     //----
@@ -144,19 +146,11 @@ int main (void) {
     // PWR_AutoWakeUpCmd (ENABLE);
     // PWR_EnterSTANDBYMode (PWR_STANDBYEntry_WFE);
 
-    NVIC_EnableIRQ (SysTick_IRQn);
-
-    SysTick->SR &= ~(1 << 0);
-    SysTick->CMP = 1000 - 1;
-    SysTick->CNT = 0;
-    SysTick->CTLR = 0xb;
-
     Motor_Init();
 
     // Восходящая трель - "данные сохранены"
     // Двойной тон с акцентом на втором
-    tone1_vol (1000, 40, 70);
-    tone1_vol (1500, 80, 100);
+    beep_Save();
 
     gotoDeepSleep();
 
@@ -164,7 +158,7 @@ int main (void) {
 
     while (1) {
 
-        Motor_Tick();
+        // Motor_Tick() работает из SysTick_Handler
 
         b.tick();
 
@@ -197,7 +191,8 @@ int main (void) {
 
 void gotoDeepSleep (void) {
 
-   
+    // Доиграть звук до конца - во сне TIM2 остановится
+    Buzzer_Wait();
 
     GPIO_InitTypeDef GPIO_InitStructure = {0};
 
@@ -241,15 +236,23 @@ void gotoDeepSleep (void) {
     printf ("Проснулись\r\n");
     // Возврат
     GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1 | GPIO_Pin_2;
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
     GPIO_Init (GPIOC, &GPIO_InitStructure);
 
-    // Возврат
+    // Зуммер: TIM2 был выключен перед сном
+    Buzzer_Init();
+#if MOTOR_USE_TACHO
+    Tacho_Init();  // PD3 был переведён в аналоговый режим
+#endif
+
+    // Возврат TX. Без UART PD6 остаётся входом: на SOP-8 это вывод шунта PA1
+#if (DEBUG != DEBUG_NONE)
     GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
     GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6;
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
     GPIO_Init (GPIOD, &GPIO_InitStructure);
+#endif
 
     //GPIO_PinRemapConfig (GPIO_Remap_SDI_Disable, DISABLE);  // Включить SWD
 }
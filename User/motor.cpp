@@ -2,61 +2,179 @@
 #include "pwm.hpp"
 #include "eeprom.hpp"
 
-extern uEeprom eeprom_power;
-extern uEeprom eeprom_boostEnable;
-extern uEeprom eeprom_boostPower;
-extern uEeprom eeprom_boostTime;
-
 Pwm motorPwm;
 
+#define MOTOR_BOOST_HZ 50    // Частота ШИМ на бусте
+#define MOTOR_RUN_HZ   5000  // Рабочая частота ШИМ после буста
+
+// PSC/ARR/коэффициенты считаются компилятором - в прерывании нет деления.
+// ARR - наибольший для частоты: на 5 кГц 1600 шагов вместо 100
+static constexpr PwmTiming PWM_BOOST = pwmTimingMax (MOTOR_BOOST_HZ);
+static constexpr PwmTiming PWM_RUN = pwmTimingMax (MOTOR_RUN_HZ);
+static constexpr PwmTiming PWM_NOBOOST = pwmTimingMax (1000);  // Старт без буста и рампа, RUNNING - всегда PWM_RUN
+static constexpr PwmTiming PWM_WAVE = pwmTiming (MOTOR_RUN_HZ);  // ARR = 100: таблицы в процентах
+
+// 1 - сигма-дельта на дробной части CCR в RUNNING (ПИ и компенсация питания)
+#define MOTOR_DITHER 1
+
+#define MOTOR_CURRENT_LIMIT 900  // Порог защиты по току, единицы АЦП (0 - выкл)
+
+// 1 - дополнительно аппаратный BKIN (PC2, активный HIGH, например от
+// компаратора на шунте). На этой плате PC2 - светодиод, поэтому по умолчанию 0
+#define MOTOR_USE_BKIN 0
+
+// 1 - буст заканчивается, когда пусковой ток спал на четверть от пика
+// (мотор раскрутился). eeprom_boostTime остаётся верхней границей (RCR)
+#define MOTOR_ADAPTIVE_BOOST 1
+#define MOTOR_BOOST_PERIOD_MS (1000 / MOTOR_BOOST_HZ)  // Отсчёт тока - раз в период
+
+// 1 - компенсация питания: на RUNNING каждый период управления CCR
+// пересчитывается так, чтобы среднее напряжение на моторе было таким же,
+// как при MOTOR_VDD_NOM_MV: ccr = ccr_ном * VDD_ном / VDD = ccr_ном * vref / vref_ном
+#define MOTOR_VDD_COMP 1
+#define MOTOR_VDD_NOM_MV 3700   // Номинал, при котором eeprom_power - как есть
+#define VREFINT_MV 1200         // Внутренний источник опорного напряжения
+
+// Отсчёт Vrefint при номинальном VDD и его обратная величина в Q24 (компилятор).
+// Q24, а не Q16: 65536 / 332 = 197.39, округление до целого давало бы 0.2%
+static constexpr uint32_t VREF_NOM = (VREFINT_MV * 1023UL + MOTOR_VDD_NOM_MV / 2) / MOTOR_VDD_NOM_MV;
+static constexpr uint32_t VREF_RECIP_Q24 = ((1UL << 24) + VREF_NOM / 2) / VREF_NOM;
+
+// Режим по оборотам (eeprom_loopMode = 1): уставка = eeprom_power % от
+// eeprom_maxRpm, обратная связь - Ripple_GetRpm, ПИ в Q15 двигает CCR
+#define MOTOR_PI_SLEW (32767 / 200)  // Выход 0 -> 100% не быстрее 200 мс (на 1 мс)
+
+// Шаг ПИ - только по новому измерению, иначе интегратор накручивался бы
+// каждую 1 мс по одному и тому же значению. Пульсации дают обороты раз в
+// окно (RIPPLE_WINDOW_MS, шаг 100 об/мин), тахо - на каждый новый период
+// (при 1 импульсе на оборот: 60 мс на 1000 об/мин). Ki и slew заданы на
+// 1 мс и на каждом шаге умножаются на время с прошлого шага (pi_ms);
+// полоса контура - порядка 1 Гц
+#define MOTOR_PI_MS_MAX 500  // Дольше без измерения тахо - уже останов (TACHO_STALL_US)
+static constexpr uint32_t Q15_PER_PCT = pwmDutyK (32767);  // % -> Q15 через pwmScale
+
 // Состояния автомата
 typedef enum {
     STATE_IDLE = 0,
     STATE_BOOST,
-    STATE_RUNNING
+    STATE_RAMP,      // Плавный разгон до рабочей мощности (без буста)
+    STATE_RUNNING,
+    STATE_STOPPING,  // Плавный останов до 0
+    STATE_WAVE,      // Огибающая из таблицы через DMA (Motor_Play)
+    STATE_FAULT  // Сработала защита (ток, остановка по тахо), выход снят. Сброс - STOP
 } motor_state_t;
 
 // Команды для мотора
 typedef enum {
     CMD_NONE = 0,
     CMD_START,
-    CMD_STOP
+    CMD_STOP,
+    CMD_SET_POWER,
+    CMD_PLAY
 } motor_cmd_t;
 
+// Очередь команд UI -> прерывание управления (без блокировок).
+// Один писатель (UI) и один читатель (Motor_Tick): UI пишет ячейку head и
+// только потом увеличивает head, прерывание читает ячейку tail и только
+// потом увеличивает tail. Команды не теряются: START и сразу за ним
+// SET_POWER в пределах одного тика выполнятся обе, по порядку.
+#define MOTOR_CMD_QUEUE 8  // Степень двойки
+
+typedef struct {
+    motor_cmd_t cmd;
+    uint8_t arg;
+} motor_msg_t;
+
+static volatile motor_msg_t motor_queue[MOTOR_CMD_QUEUE];
+static volatile uint8_t motor_head = 0;  // Пишет только UI
+static volatile uint8_t motor_tail = 0;  // Пишет только Motor_Tick
+
 // Внутренние переменные состояния
-static motor_state_t motor_state = STATE_IDLE;
-static volatile motor_cmd_t motor_cmd = CMD_NONE;
-static uint64_t boost_start_time = 0;
+static volatile motor_state_t motor_state = STATE_IDLE;
+static volatile uint8_t motor_ready = 0;     // SysTick стартует раньше Motor_Init
+
+static uint8_t run_power = 0;  // Рабочая мощность, % (до компенсации)
+
+static uint8_t loop_closed = 0;  // Режим по оборотам на текущем запуске
+static uint16_t rpm_k = 0;       // об/мин -> Q15 в Q8: 32768 * 256 / maxRpm
+static Pi_t motor_pi;
+static uint16_t pi_ki = 0;       // eeprom_piKi - Ki на 1 мс
+static uint16_t pi_ms = 0;       // мс с прошлого шага ПИ
+
+static Ramp_t motor_ramp;  // Плавный разгон/останов, шаг - Motor_Tick
+
+// Огибающая для CMD_PLAY. Пишет UI до публикации команды; несколько PLAY
+// в очереди - играет последняя переданная таблица
+static struct {
+    const uint16_t *tab;
+    uint16_t len;
+    uint8_t hold;
+    uint8_t loop;
+} motor_wave;
+
+#if MOTOR_ADAPTIVE_BOOST
+static uint16_t boost_ms = 0;    // Время в бусте, тиков по 1 мс
+static uint16_t boost_peak = 0;  // Пиковый ток на бусте
+#endif
+
+static void Motor_Post (motor_cmd_t cmd, uint8_t arg = 0) {
+    // Очередь полна - ждём, пока Motor_Tick заберёт команду (до 1 мс).
+    // До Motor_Init прерывание очередь не разбирает - команда отбрасывается
+    while ((uint8_t)(motor_head - motor_tail) >= MOTOR_CMD_QUEUE) {
+        if (!motor_ready)
+            return;
+    }
+
+    uint8_t i = motor_head & (MOTOR_CMD_QUEUE - 1);
+    motor_queue[i].cmd = cmd;
+    motor_queue[i].arg = arg;
+    motor_head++;  // Публикация
+}
 
 // ============================================================================
 // PUBLIC API - вызывается извне (обработчики кнопок, UART команды и т.д.)
 // ============================================================================
 
 void Motor_Init (void) {
-    motorPwm.init (100, 7, 50);
-    motorPwm.setDutyPercent (0);
-    motorPwm.setFrequency (50);
-    motorPwm.disable();
+    motorPwm.init (100, 7, 0);
+    motorPwm.dither = MOTOR_DITHER;
+    motorPwm.disable();  // Таймер идёт всегда, выход припаркован в LOW
+    motorPwm.apply (PWM_BOOST, 0);
+    Current_Init();  // АЦП по событию TIM1 CC1
+    Current_SetLimit (MOTOR_CURRENT_LIMIT);
+#if MOTOR_USE_TACHO
+    Tacho_Init();  // TIM2 уже настроен зуммером
+#endif
+
+#if MOTOR_USE_BKIN
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    RCC_APB2PeriphClockCmd (RCC_APB2Periph_GPIOC, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;  // PC2 = TIM1_BKIN
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPD;
+    GPIO_Init (GPIOC, &GPIO_InitStructure);
+    TIM1->BDTR |= TIM_BKE | TIM_BKP;  // HIGH на BKIN аппаратно снимает MOE
+#endif
     motor_state = STATE_IDLE;
-    motor_cmd = CMD_NONE;
+    motor_tail = motor_head;
+    motor_ready = 1;
 }
 
 // Установить команду START (неблокирующая)
 void Motor_Start (void) {
-    motor_cmd = CMD_START;
+    Motor_Post (CMD_START);
 }
 
 // Установить команду STOP (неблокирующая)
 void Motor_Stop (void) {
-    motor_cmd = CMD_STOP;
+    Motor_Post (CMD_STOP);
 }
 
 // Переключить состояние мотора (вкл/выкл)
 void Motor_Toggle (void) {
     if (motor_state == STATE_IDLE) {
-        motor_cmd = CMD_START;
+        Motor_Post (CMD_START);
     } else {
-        motor_cmd = CMD_STOP;
+        Motor_Post (CMD_STOP);
     }
 }
 
@@ -69,47 +187,181 @@ int Motor_isStop (void) {
     return motor_state == STATE_IDLE;
 }
 
+int Motor_isFault (void) {
+    return motor_state == STATE_FAULT;
+}
+
+// Обороты: тахо-датчик, если есть, иначе пульсации тока
+static uint16_t Motor_Rpm (void) {
+#if MOTOR_USE_TACHO
+    return Tacho_GetRpm();
+#else
+    return Ripple_GetRpm();
+#endif
+}
+
+uint16_t Motor_GetRpm (void) {
+    return (motor_state == STATE_RUNNING) ? Motor_Rpm() : 0;
+}
+
+// Переход на рабочий режим: оценка оборотов начинается заново.
+// Частота - рабочая с любого пути (после буста она уже в таймере, после
+// старта без буста и рампы - 1 кГц): пульсации считаются при fs = 5 кГц,
+// на 1 кГц оценка выше ~3000 об/мин занижена. Мощность - текущая
+static void Motor_EnterRunning (void) {
+    motorPwm.apply (PWM_RUN, run_power);
+    Ripple_Reset();
+#if MOTOR_USE_TACHO
+    Tacho_Reset();  // Отсчёт остановки - с этого момента
+#endif
+    if (loop_closed)
+        Pi_Reset (&motor_pi, pwmScale (run_power, Q15_PER_PCT));  // Безударно с разомкнутого
+    pi_ms = 0;
+    motor_state = STATE_RUNNING;
+}
+
+// Остановить сразу: выход в LOW, не дожидаясь конца периода
+static void Motor_Halt (void) {
+    Wave_Stop();
+    motorPwm.disable();
+    motorPwm.setDutyPercent (0);
+    motor_state = STATE_IDLE;
+}
+
+// Аппаратная защита уже сработала (MOE снят сторожем АЦП или BKIN)
+static int Motor_Tripped (void) {
+    if (Current_IsFault())
+        return 1;
+#if MOTOR_USE_BKIN
+    if (TIM1->INTFR & TIM_BIF)
+        return 1;
+#endif
+    return 0;
+}
+
+// Включить выход. MOE ставится чтением-изменением-записью BDTR: если сторож
+// АЦП снимет MOE между чтением и записью, запись его вернёт. На это время
+// прерывание АЦП выключено (срабатывание дождётся и снимет MOE сразу после),
+// а защёлка проверяется ещё раз - срабатывание до включения не теряется
+static void Motor_Enable (void) {
+    NVIC_DisableIRQ (ADC_IRQn);
+    motorPwm.enable();
+    NVIC_EnableIRQ (ADC_IRQn);
+
+    if (Motor_Tripped())
+        motorPwm.disable();
+}
+
 // ============================================================================
-// TICK FUNCTION - вызывается в главном цикле
+// TICK FUNCTION - вызывается из SysTick_Handler с периодом 1 мс
 // ============================================================================
+// Период не зависит от главного цикла (звуки, delay). Внутри нет циклов
+// ожидания - время выполнения ограничено.
 
 void Motor_Tick (void) {
-    // Обработка команд в первую очередь
-    if (motor_cmd != CMD_NONE) {
-        motor_cmd_t cmd = motor_cmd;
-        motor_cmd = CMD_NONE;  // Сбрасываем команду сразу
+    if (!motor_ready) return;
+
+    // Обработка команд в первую очередь: все накопившиеся, по порядку
+    while (motor_tail != motor_head) {
+        uint8_t i = motor_tail & (MOTOR_CMD_QUEUE - 1);
+        motor_cmd_t cmd = motor_queue[i].cmd;
+        uint8_t arg = motor_queue[i].arg;
+        motor_tail++;
 
         switch (cmd) {
         case CMD_START:
             if (motor_state == STATE_IDLE) {
-                motorPwm.enable();
-
-                if (eeprom_boostEnable.get() == 0) {
-                    // Буст выключен - сразу на рабочую мощность
-                    motorPwm.setFrequency (1000);
-                    int p = eeprom_power.get();
-                    if (p > 100)
-                        p = 100;
-                    motorPwm.setDutyPercent (p);
-                    motor_state = STATE_RUNNING;
+                int p = eeprom_power.get();
+                if (p > 100)
+                    p = 100;
+                run_power = p;
+
+                // Параметры регулятора - один раз на запуск (здесь деление допустимо)
+                loop_closed = eeprom_loopMode.get() ? 1 : 0;
+                if (loop_closed) {
+                    motor_pi.kp = eeprom_piKp.get();
+                    pi_ki = eeprom_piKi.get();  // Ki и slew шага - по pi_ms в RUNNING
+                    rpm_k = (32768UL << 8) / eeprom_maxRpm.get();
+                }
+
+                // Длительность буста в периодах частоты буста (20 мс при 50 Гц)
+                uint32_t periods = 0;
+                if (eeprom_boostEnable.get() != 0) {
+                    periods = (eeprom_boostTime.get() * MOTOR_BOOST_HZ + 500) / 1000;
+                    if (periods > 256)
+                        periods = 256;
+                }
+
+                if (periods == 0) {
+                    // Буст выключен - на рабочую мощность, плавно если задана рампа
+                    uint16_t ramp = eeprom_rampTime.get();
+                    motorPwm.apply (PWM_NOBOOST, ramp ? 0 : p);
+                    motorPwm.setRepetition (0);
+                    motorPwm.update();
+                    Motor_Enable();
+                    if (ramp) {
+                        Ramp_Start (&motor_ramp, 0, pwmScale (p, motorPwm.k), ramp, eeprom_rampShape.get());
+                        motor_state = STATE_RAMP;
+                    } else {
+                        Motor_EnterRunning();
+                    }
                 } else {
-                    // Буст включен - стартуем с boost мощности
-                    motorPwm.setFrequency (50);
-                    int pp = eeprom_power.get() + eeprom_boostPower.get();
+                    // Буст - намеренно резкий пинок, рампа к нему не применяется
+                    // Буст включен - стартуем с boost мощности.
+                    // Буст грузим в рабочие регистры через UG, а рабочий режим
+                    // оставляем в предзагрузке. Таймер сам отработает ровно
+                    // periods периодов (RCR) и на событии обновления перейдёт
+                    // на рабочие частоту и мощность - без участия CPU.
+                    int pp = p + eeprom_boostPower.get();
                     if (pp > 100)
                         pp = 100;
-                    motorPwm.setDutyPercent (pp);
-                    boost_start_time = millisec;
+                    motorPwm.apply (PWM_BOOST, pp);
+                    motorPwm.setRepetition (periods - 1);
+                    motorPwm.update();
+                    Motor_Enable();
+
+                    motorPwm.apply (PWM_RUN, p);
+                    motorPwm.setRepetition (0);
+#if MOTOR_ADAPTIVE_BOOST
+                    boost_ms = 0;
+                    boost_peak = 0;
+#endif
                     motor_state = STATE_BOOST;
                 }
+                // UG перезапускает период: выход стартует с начала периода
             }
             break;
 
         case CMD_STOP:
-            // STOP работает из любого состояния
-            motorPwm.setDutyPercent (0);
-            motorPwm.disable();
-            motor_state = STATE_IDLE;
+            // STOP работает из любого состояния и сбрасывает FAULT.
+            // С рабочего режима - плавно (если задана рампа), повторный STOP
+            // во время останова, из буста и из FAULT - сразу
+            if ((motor_state == STATE_RUNNING || motor_state == STATE_RAMP) && eeprom_rampTime.get()) {
+                Ramp_Start (&motor_ramp, motorPwm.ccp, 0, eeprom_rampTime.get(), eeprom_rampShape.get());
+                motor_state = STATE_STOPPING;
+                break;
+            }
+            Motor_Halt();
+            Current_ClearFault();
+            TIM1->INTFR = (uint16_t)~TIM_BIF;
+            break;
+
+        case CMD_SET_POWER:
+            run_power = (arg > 100) ? 100 : arg;
+            if (motor_state == STATE_RUNNING && !loop_closed) {
+                motorPwm.setDutyPercent (arg);
+            }
+            break;
+
+        case CMD_PLAY:
+            if (motor_state == STATE_IDLE) {
+                // Таблица в тиках CCR при ARR = 100 - это проценты
+                motorPwm.apply (PWM_WAVE, 0);
+                motorPwm.update();
+                Wave_Play (motor_wave.tab, motor_wave.len, motor_wave.hold, motor_wave.loop);
+                Motor_Enable();
+                motor_state = STATE_WAVE;
+            }
             break;
 
         default:
@@ -117,6 +369,14 @@ void Motor_Tick (void) {
         }
     }
 
+    // Защита срабатывает в прерывании за мкс, здесь только защёлкиваем FAULT
+    if (motor_state != STATE_FAULT && Motor_Tripped()) {
+        Wave_Stop();
+        motorPwm.disable();
+        motorPwm.setDutyPercent (0);
+        motor_state = STATE_FAULT;
+    }
+
     // Обработка состояний
     switch (motor_state) {
     case STATE_IDLE:
@@ -124,18 +384,105 @@ void Motor_Tick (void) {
         break;
 
     case STATE_BOOST:
-        // Проверяем, истекло ли время буста
-        if ((millisec - boost_start_time) >= eeprom_boostTime.get()) {
-            // Переходим на рабочую частоту и мощность
-            motorPwm.setFrequency (5000);
-            motorPwm.setDutyPercent (eeprom_power.get());
-            motor_state = STATE_RUNNING;
+        // Конец буста отрабатывает таймер, здесь только фиксируем состояние
+        if (motorPwm.isUpdated()) {
+            Motor_EnterRunning();
+            break;
+        }
+
+#if MOTOR_ADAPTIVE_BOOST
+        // Первый период пропускаем: в кольце ещё отсчёт прошлого запуска
+        if (++boost_ms > MOTOR_BOOST_PERIOD_MS) {
+            uint16_t i = Current_Last();
+            if (i > boost_peak)
+                boost_peak = i;
+
+            // Минимум два свежих отсчёта, затем ток ниже 3/4 пика - мотор раскрутился
+            if (boost_ms >= 3 * MOTOR_BOOST_PERIOD_MS && i < boost_peak - (boost_peak >> 2)) {
+                motorPwm.update();  // UG: рабочий режим из предзагрузки - сразу
+                Motor_EnterRunning();
+            }
         }
+#endif
         break;
 
     case STATE_RUNNING:
         // Мотор работает на рабочей мощности
-        // Можно добавить мониторинг или другую логику
+#if MOTOR_USE_TACHO
+        // Фронтов нет дольше TACHO_STALL_US - ротор заклинило
+        if (Tacho_IsStalled()) {
+            motorPwm.disable();
+            motorPwm.setDutyPercent (0);
+            motor_state = STATE_FAULT;
+            break;
+        }
+#endif
+
+        {
+            uint8_t fresh = Ripple_Tick();
+#if MOTOR_USE_TACHO
+            fresh = Tacho_Tick();
+#endif
+            if (pi_ms < MOTOR_PI_MS_MAX)
+                pi_ms++;
+            if (loop_closed && !fresh)
+                break;  // Измерение не обновилось - выход прежний
+        }
+
+        if (loop_closed) {
+            // Ki и slew - на время с прошлого шага. Ki > 327 при окне 100 мс - предел
+            uint32_t ki = pwmMul (pi_ki, pi_ms);
+            uint32_t slew = pwmMul (MOTOR_PI_SLEW, pi_ms);
+            motor_pi.ki = (ki > 32767) ? 32767 : ki;
+            motor_pi.slew = (slew > 32767) ? 32767 : slew;
+            pi_ms = 0;
+
+            // Уставка и измерение в Q15
+            int16_t sp = pwmScale (run_power, Q15_PER_PCT);
+            uint32_t pv = pwmMul (rpm_k, Motor_Rpm()) >> 8;
+            if (pv > 32767)
+                pv = 32767;
+
+            int16_t u = Pi_Step (&motor_pi, sp, (int16_t)pv);
+            motorPwm.setDutyQ16 ((uint32_t)u << 1);
+            break;
+        }
+
+#if MOTOR_VDD_COMP
+        {
+            uint16_t vref = Current_Vref();
+            if (vref) {
+                // Без деления и без __mulsi3: vref * (1 / vref_ном) в Q16 сдвигами
+                // и сложениями (pwmMul). Переполнения нет: 1023 * VREF_RECIP_Q24
+                // < 2^26, ccr * ratio < 2^32 при arr <= 20000
+                uint32_t ratio = pwmMul (VREF_RECIP_Q24, vref) >> 8;
+                motorPwm.setDutyFine (pwmMul (ratio, pwmScale (run_power, motorPwm.k)));  // CCR в Q16
+            }
+        }
+#endif
+        break;
+
+    case STATE_RAMP:
+        motorPwm.setDuty (Ramp_Step (&motor_ramp));
+        if (Ramp_Done (&motor_ramp)) {
+            Motor_EnterRunning();  // Мощность могли сменить во время рампы
+        }
+        break;
+
+    case STATE_STOPPING:
+        motorPwm.setDuty (Ramp_Step (&motor_ramp));
+        if (Ramp_Done (&motor_ramp))
+            Motor_Halt();
+        break;
+
+    case STATE_WAVE:
+        // CCR пишет DMA. Однократная огибающая закончилась - останов
+        if (Wave_IsDone())
+            Motor_Halt();
+        break;
+
+    case STATE_FAULT:
+        // Выход снят, ждём STOP (нажатие кнопки)
         break;
     }
 }
@@ -145,7 +492,19 @@ void Motor_Tick (void) {
 // ============================================================================
 
 void Motor_SetPower (uint8_t power_percent) {
-    if (motor_state == STATE_RUNNING) {
-        motorPwm.setDutyPercent (power_percent);
-    }
+    Motor_Post (CMD_SET_POWER, power_percent);
+}
+
+// ============================================================================
+// OPTIONAL: Огибающая заполнения (вибрация, импульсы) без процессора
+// ============================================================================
+// tab - таблица WAVE_PT(ccr) во флеше, len - число точек, каждая точка
+// hold + 1 периодов ШИМ 5 кГц. loop = 1 - до STOP, 0 - один раз и останов
+
+void Motor_Play (const uint16_t *tab, uint16_t len, uint8_t hold, uint8_t loop) {
+    motor_wave.tab = tab;
+    motor_wave.len = len;
+    motor_wave.hold = hold;
+    motor_wave.loop = loop;
+    Motor_Post (CMD_PLAY);
 }
\ No newline at end of file
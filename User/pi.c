@@ -0,0 +1,77 @@
+#include <debug.h>
+
+/*
+ * ПИ-регулятор в Q15 (32767 = 1.0).
+ * Ядро RV32EC без умножения, поэтому вместо __mulsi3 (до 32 итераций)
+ * умножение на коэффициент - сдвиг-сложение ровно по 15 битам: время
+ * Pi_Step фиксировано и не зависит от данных.
+ * Интегратор хранится в Q30, чтобы малые ошибки при малом Ki не терялись.
+ * Антивиндап: интегратор ограничен диапазоном выхода и не растёт, пока
+ * выход в насыщении. Выход ограничен по скорости (slew).
+ */
+
+/* x * k, |x| <= 32767, k = 0..32767: результат в Q30, ровно 15 итераций */
+static int32_t Pi_Mul (int32_t x, uint16_t k) {
+    int32_t r = 0;
+
+    for (uint8_t i = 0; i < 15; i++) {
+        if (k & 1)
+            r += x;
+        x <<= 1;
+        k >>= 1;
+    }
+    return r;
+}
+
+/*********************************************************************
+ * @fn      Pi_Reset
+ *
+ * @brief   Безударный старт: интегратор и выход = out
+ *
+ * @param   out - начальный выход, Q15 0..32767
+ *
+ * @return  none
+ */
+void Pi_Reset (Pi_t *pi, int16_t out) {
+    pi->integ = (int32_t)out << 15;
+    pi->out = out;
+}
+
+/*********************************************************************
+ * @fn      Pi_Step
+ *
+ * @brief   Шаг регулятора
+ *
+ * @param   sp - уставка, Q15 0..32767
+ *          pv - измерение, Q15 0..32767
+ *
+ * @return  выход, Q15 0..32767
+ */
+int16_t Pi_Step (Pi_t *pi, int16_t sp, int16_t pv) {
+    int32_t e = (int32_t)sp - pv;  // -32767..32767
+    int32_t p = Pi_Mul (e, pi->kp) >> 15;
+    int32_t i = pi->integ + Pi_Mul (e, pi->ki);  // Q30, |слагаемые| < 2^30
+
+    // Антивиндап: интегратор в пределах выхода
+    if (i > (32767L << 15))
+        i = 32767L << 15;
+    if (i < 0)
+        i = 0;
+
+    int32_t u = p + (i >> 15);
+    if (u > 32767)
+        u = 32767;
+    else if (u < 0)
+        u = 0;
+    else
+        pi->integ = i;  // Интегрируем только вне насыщения
+
+    // Ограничение скорости изменения выхода
+    if (u > pi->out + pi->slew)
+        u = pi->out + pi->slew;
+    if (u < pi->out - pi->slew)
+        u = pi->out - pi->slew;
+
+    pi->out = (int16_t)u;
+    return pi->out;
+}
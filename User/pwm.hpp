@@ -9,76 +9,270 @@
 /* PWM Output Mode Selection */
 #define PWM_MODE PWM_MODE2
 
-class Pwm {
+/* Режим ШИМ для Pwm::apply() - частота и заполнение применяются вместе */
+struct PwmConfig {
+    uint32_t freq_hz;      // Частота, Гц
+    uint8_t duty_percent;  // Заполнение, 0..100
+};
+
+/*
+ * Готовые значения регистров для частоты ШИМ.
+ * Ядро RV32EC без умножения/деления (нет расширения M), поэтому PSC и
+ * коэффициент процентов считаются на этапе компиляции через pwmTiming(),
+ * а в рантайме остаются только сдвиги и сложения.
+ */
+struct PwmTiming {
+    uint16_t psc;  // PSC
+    uint16_t arr;  // Период в тиках (ATRLR = arr - 1)
+    uint32_t k;    // arr / 100 в Q16 (с округлением вверх): ccr = (percent * k) >> 16
+};
+
+/* Коэффициент процентов для периода arr: ceil (arr * 65536 / 100) */
+constexpr uint32_t pwmDutyK (uint16_t arr) {
+    return (((uint32_t)arr << 16) + 99) / 100;
+}
+
+/* PSC = F_CPU / (freq * ARR) - 1, ограничение 0..65535 */
+constexpr uint32_t pwmPsc (uint32_t freq_hz, uint16_t arr, uint32_t f_cpu) {
+    return (f_cpu / (freq_hz * arr) > 65536) ? 65535
+         : (f_cpu / (freq_hz * arr) == 0)    ? 0
+                                             : f_cpu / (freq_hz * arr) - 1;
+}
+
+/*
+ * Пример: static constexpr PwmTiming PWM_5K = pwmTiming (5000);
+ * Вызов с константами считается компилятором, с переменными - в рантайме
+ * (с делением, для редких случаев).
+ */
+constexpr PwmTiming pwmTiming (uint32_t freq_hz, uint16_t arr = 100, uint32_t f_cpu = 8000000) {
+    return PwmTiming { (uint16_t)pwmPsc (freq_hz ? freq_hz : 1, arr ? arr : 1, f_cpu),
+                       (uint16_t)(arr ? arr : 1),
+                       pwmDutyK (arr ? arr : 1) };
+}
+
+/* Наименьший PSC, при котором период влезает в 16-битный ARR */
+constexpr uint32_t pwmPscMax (uint32_t freq_hz, uint32_t f_cpu) {
+    return (f_cpu / freq_hz == 0)                ? 0
+         : (f_cpu / freq_hz > 65535UL * 65536UL) ? 65535
+                                                 : (f_cpu / freq_hz + 65534) / 65535 - 1;
+}
+
+/*
+ * Частота с максимальным ARR, который она допускает (максимум шагов заполнения).
+ * Пример: pwmTimingMax (5000) -> PSC 0, ARR 1600 при 8 МГц (шаг 0.0625%)
+ */
+constexpr PwmTiming pwmTimingMax (uint32_t freq_hz, uint32_t f_cpu = 8000000) {
+    return pwmTiming (freq_hz, (uint16_t)(f_cpu / (freq_hz ? freq_hz : 1) / (pwmPscMax (freq_hz ? freq_hz : 1, f_cpu) + 1)), f_cpu);
+}
+
+/*
+ * a * b сдвигом и сложением по битам b (до 16 итераций вместо __mulsi3).
+ * Переполнение - на совести вызывающего
+ */
+static inline uint32_t pwmMul (uint32_t a, uint16_t b) {
+    uint32_t r = 0;
+    while (b) {
+        if (b & 1)
+            r += a;
+        a <<= 1;
+        b >>= 1;
+    }
+    return r;
+}
+
+/*
+ * percent * k >> 16 сдвигом и сложением по 7 битам процента:
+ * ~7 итераций вместо программного __mulsi3 по 32 битам
+ */
+static inline uint16_t pwmScale (uint8_t percent, uint32_t k) {
+    uint32_t r = 0;
+    while (percent) {
+        if (percent & 1)
+            r += k;
+        k <<= 1;
+        percent >>= 1;
+    }
+    return (uint16_t)(r >> 16);
+}
+
+/*
+ * Канал ШИМ, заданный на этапе компиляции:
+ *   TimBase  - TIM1_BASE или TIM2_BASE
+ *   Ch       - канал 1..4
+ *   NOut     - true: выход CHxN (есть только у TIM1), false: основной CHx
+ *   PortBase - GPIOA_BASE / GPIOC_BASE / GPIOD_BASE
+ *   Pin      - номер вывода 0..7
+ *   TrigCh   - 0 или свободный канал того же таймера: его CCR держится
+ *              равным CCR/2 (середина импульса), событие CCx запускает АЦП
+ * Адреса регистров и маски - константы, поэтому setDuty() сводится к
+ * одной записи в CHxCVR, а enable()/disable() - к нескольким записям в
+ * регистры, без SPL и без ветвлений во время выполнения.
+ */
+template <uint32_t TimBase, uint8_t Ch, bool NOut, uint32_t PortBase, uint8_t Pin, uint8_t TrigCh = 0>
+class PwmT {
+    static_assert (Ch >= 1 && Ch <= 4, "PwmT: channel 1..4");
+    static_assert (!NOut || TimBase == TIM1_BASE, "PwmT: CHxN output exists on TIM1 only");
+    static_assert (Pin <= 7, "PwmT: pin 0..7");
+    static_assert (TrigCh <= 4 && TrigCh != Ch, "PwmT: trigger channel 0 (none) or another channel 1..4");
+
+    static const bool isTim1 = (TimBase == TIM1_BASE);
+
+    static const uint8_t CH_SHIFT = ((Ch - 1) & 1) * 8;    // Половина CHCTLRx
+    static const uint8_t CCER_SHIFT = (Ch - 1) * 4;        // Поле канала в CCER
+    static const uint16_t CCER_EN = (NOut ? TIM_CC1NE : TIM_CC1E) << CCER_SHIFT;
+
+    static const uint32_t CFG_MASK = 0xFul << (Pin * 4);
+    static const uint32_t CFG_AF = 0xBul << (Pin * 4);   // AF_PP, 30 МГц
+
+    static const uint32_t PORT_CLOCK = (PortBase == GPIOA_BASE)   ? RCC_APB2Periph_GPIOA
+                                       : (PortBase == GPIOC_BASE) ? RCC_APB2Periph_GPIOC
+                                                                  : RCC_APB2Periph_GPIOD;
+
+    // Типы регистров - из TIM_TypeDef (тест на хосте, test/, подставляет свой)
+    typedef decltype (TIM_TypeDef::CHCTLR1) reg16_t;
+    typedef decltype (TIM_TypeDef::CH1CVR) reg32_t;
+
+    static TIM_TypeDef *tim() { return (TIM_TypeDef *)TimBase; }
+    static GPIO_TypeDef *port() { return (GPIO_TypeDef *)PortBase; }
+    static reg16_t &chctlr() { return (Ch <= 2) ? tim()->CHCTLR1 : tim()->CHCTLR2; }
+    static reg32_t &ccr() { return (&tim()->CH1CVR)[Ch - 1]; }
+
+    // Канал запуска АЦП (при TrigCh = 0 не используется)
+    static const uint8_t TC = TrigCh ? TrigCh : 1;
+    static const uint8_t TRIG_SHIFT = ((TC - 1) & 1) * 8;
+    static reg16_t &trigChctlr() { return (TC <= 2) ? tim()->CHCTLR1 : tim()->CHCTLR2; }
+    static reg32_t &trigCcr() { return (&tim()->CH1CVR)[TC - 1]; }
+
   public:
-    Pwm() { }
+    PwmT() { }
 
     uint16_t arr = 100;
     uint16_t ccp = 50;
     uint16_t psc = 0;
+    uint32_t k = pwmDutyK (100);  // Коэффициент процентов для текущего arr
+    uint8_t pct = 50;             // Последнее заполнение в процентах
+    uint8_t dither = 0;           // 1 - сигма-дельта на дробной части CCR (setDutyFine)
 
     /*********************************************************************
-     * @fn      TIM1_PWMOut_Init
+     * @fn      init
      *
-     * @brief   Initializes TIM1 Channel 2N PWM Output on PA2
+     * @brief   Инициализация таймера, канала и вывода ШИМ
      *
      * @param   _arr - период (ARR). Например: 100
      *          psc  - предделитель. Например: 479 для ~1kHz при 48MHz
-     *          _ccp - заполнение (CCR2). Диапазон: 0..arr
+     *          _ccp - заполнение (CCRx). Диапазон: 0..arr
      *
      * @return  none
+     *
+     * @note    Таймер настраивается целиком (PSC/ARR общие для всех каналов).
+     *          Ремап выводов (AFIO) делается снаружи
      */
     void init (uint16_t _arr, uint16_t _psc, uint16_t _ccp) {
         // Защита от нулевого периода
         arr = (_arr == 0) ? 1 : _arr;
         psc = _psc;
+        k = pwmDutyK (arr);
 
         // Ограничение duty cycle
         ccp = (_ccp > arr) ? arr : _ccp;
 
-        GPIO_InitTypeDef GPIO_InitStructure = {0};
-        TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
-        TIM_OCInitTypeDef TIM_OCInitStructure = {0};
-
         /* 1) Включение тактирования */
-        RCC_APB2PeriphClockCmd (RCC_APB2Periph_GPIOA |
-                                    RCC_APB2Periph_TIM1,
-                                ENABLE);
-
-        /* 2) Настройка PA2 как Alternate Function Push-Pull для TIM1_CH2N */
-        GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;  // PA2 = TIM1_CH2N
-        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
-        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-        GPIO_Init (GPIOA, &GPIO_InitStructure);
-
-        /* 3) Базовая настройка таймера */
-        TIM_TimeBaseInitStructure.TIM_Period = arr - 1;  // ARR (0-based)
-        TIM_TimeBaseInitStructure.TIM_Prescaler = psc;
-        TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
-        TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
-        TIM_TimeBaseInitStructure.TIM_RepetitionCounter = 0;
-        TIM_TimeBaseInit (TIM1, &TIM_TimeBaseInitStructure);
-
-        /* 4) Настройка канала 2 в режиме PWM Mode 1 с N-выходом */
-        TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
-        TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Disable;   // Основной выход НЕ используем
-        TIM_OCInitStructure.TIM_OutputNState = TIM_OutputNState_Enable;  // Используем N-выход (PA2)
-        TIM_OCInitStructure.TIM_Pulse = ccp;
-        TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
-        TIM_OCInitStructure.TIM_OCNPolarity = TIM_OCNPolarity_High;  // Прямая полярность для CH2N
-        TIM_OCInitStructure.TIM_OCIdleState = TIM_OCIdleState_Reset;
-        TIM_OCInitStructure.TIM_OCNIdleState = TIM_OCNIdleState_Reset;
-        TIM_OC2Init (TIM1, &TIM_OCInitStructure);
-
-        /* 5) Включение предзагрузки */
-        TIM_OC2PreloadConfig (TIM1, TIM_OCPreload_Enable);
-        TIM_ARRPreloadConfig (TIM1, ENABLE);
-
-        /* 6) ВАЖНО: Включаем главный выход MOE для TIM1 */
-        TIM_CtrlPWMOutputs (TIM1, ENABLE);
-
-        /* 7) Запуск таймера */
-        TIM_Cmd (TIM1, ENABLE);
+        if (isTim1)
+            RCC->APB2PCENR |= RCC_APB2Periph_TIM1;
+        else
+            RCC->APB1PCENR |= RCC_APB1Periph_TIM2;
+        RCC->APB2PCENR |= PORT_CLOCK;
+
+        /* 2) Вывод в Alternate Function Push-Pull */
+        port()->CFGLR = (port()->CFGLR & ~CFG_MASK) | CFG_AF;
+
+        /* 3) Базовая настройка таймера: счёт вверх, предзагрузка ARR,
+              UIF только от переполнения - программный UG (update()) флаг не ставит */
+        tim()->CTLR1 = TIM_ARPE | TIM_URS;
+        tim()->PSC = psc;
+        tim()->ATRLR = arr - 1;  // ARR (0-based)
+        if (isTim1)
+            tim()->RPTCR = 0;
+
+        /* 4) Канал в режиме PWM Mode 1 (OCxM = 110) с предзагрузкой CCR */
+        chctlr() = (chctlr() & ~(0xFF << CH_SHIFT)) | ((TIM_OC1M_2 | TIM_OC1M_1 | TIM_OC1PE) << CH_SHIFT);
+        ccr() = ccp;
+
+        /* 5) Выход канала (основной или N), прямая полярность */
+        tim()->CCER = (tim()->CCER & ~(0xF << CCER_SHIFT)) | CCER_EN;
+
+        /* 5a) Канал запуска АЦП: PWM Mode 2, фронт OCxREF на CCR/2.
+               Его вывод не переводится в AF, наружу сигнал не выходит */
+        if (TrigCh) {
+            trigChctlr() = (trigChctlr() & ~(0xFF << TRIG_SHIFT)) | ((TIM_OC1M | TIM_OC1PE) << TRIG_SHIFT);
+            trigCcr() = ccp >> 1;
+            tim()->CCER |= TIM_CC1E << ((TC - 1) * 4);
+        }
+
+        /* 6) Загрузка предзагрузки в рабочие регистры */
+        tim()->SWEVGR = TIM_UG;
+
+        /* 7) ВАЖНО: у TIM1 выходы работают только при MOE.
+              OSSI = 1: при MOE = 0 выход держит уровень покоя OISx/OISxN
+              (CTLR2 после сброса = 0 -> LOW), а не отпускается в Hi-Z */
+        if (isTim1)
+            tim()->BDTR |= TIM_MOE | TIM_OSSI;
+
+        /* 8) Запуск таймера */
+        tim()->CTLR1 |= TIM_CEN;
+    }
+
+    /*********************************************************************
+     * @fn      apply
+     *
+     * @brief   Атомарная смена частоты и заполнения
+     *
+     * @param   t       - значения регистров, см. pwmTiming()
+     *          percent - заполнение 0..100
+     *
+     * @return  none
+     *
+     * @note    PSC, ARR и CCR пишутся в предзагрузку при UDIS = 1, поэтому
+     *          событие обновления не может попасть между записями. Все три
+     *          значения вступают в силу вместе на границе периода - не бывает
+     *          периода с новым PSC и старым CCR.
+     *          Без деления: с constexpr PwmTiming это десятки тактов
+     *          Пример: motorPwm.apply (PWM_5K, 40);
+     */
+    void apply (const PwmTiming &t, uint8_t percent) {
+        if (percent > 100)
+            percent = 100;
+
+        psc = t.psc;
+        arr = t.arr;
+        k = t.k;
+        pct = percent;
+        ccp = pwmScale (percent, k);
+
+        lock();
+        tim()->PSC = psc;
+        tim()->ATRLR = arr - 1;
+        ccr() = ccp;
+        if (TrigCh)
+            trigCcr() = ccp >> 1;
+        unlock();
+    }
+
+    /*********************************************************************
+     * @fn      apply
+     *
+     * @brief   То же для произвольной частоты, известной только в рантайме
+     *
+     * @param   cfg   - { частота Гц, заполнение % }
+     *          f_cpu - частота процессора в Герцах (по умолчанию 8000000)
+     *
+     * @return  none
+     *
+     * @note    Считает PSC делением - для редких вызовов.
+     *          Пример: motorPwm.apply ({5000, 40});
+     */
+    void apply (const PwmConfig &cfg, uint32_t f_cpu = 8000000) {
+        apply (pwmTiming (cfg.freq_hz, arr, f_cpu), cfg.duty_percent);
     }
 
     /*********************************************************************
@@ -86,7 +280,7 @@ class Pwm {
      *
      * @brief   Изменение скважности PWM (на лету, без остановки таймера)
      *
-     * @param   duty - значение CCR2 (0 = 0%, arr = 100%)
+     * @param   duty - значение CCRx (0 = 0%, arr = 100%)
      *
      * @return  none
      */
@@ -94,7 +288,9 @@ class Pwm {
         if (duty > arr)
             duty = arr;
         ccp = duty;
-        TIM_SetCompare2 (TIM1, duty);  // Применится на следующем обновлении
+        ccr() = duty;  // Применится на следующем обновлении
+        if (TrigCh)
+            trigCcr() = duty >> 1;
     }
 
     /*********************************************************************
@@ -109,10 +305,67 @@ class Pwm {
     void setDutyPercent (uint8_t percent) {
         if (percent > 100)
             percent = 100;
-        uint16_t duty = (arr * percent) / 100;
+        pct = percent;
+        setDuty (pwmScale (percent, k));  // Без деления на 100
+    }
+
+    /*********************************************************************
+     * @fn      setDutyFine
+     *
+     * @brief   Заполнение с дробной частью тика таймера
+     *
+     * @param   ccr16 - CCR в Q16: старшие 16 бит - тики, младшие - доля тика
+     *
+     * @return  none
+     *
+     * @note    При dither = 1 дробная часть копится сигма-дельтой первого
+     *          порядка: вызов с переносом получает CCR + 1. При вызове раз в
+     *          несколько периодов ШИМ (Motor_Tick, 1 мс) среднее заполнение
+     *          точнее одного тика. При dither = 0 дробь отбрасывается
+     */
+    void setDutyFine (uint32_t ccr16) {
+        uint16_t duty = ccr16 >> 16;
+        if (dither) {
+            uint16_t lo = (uint16_t)ccr16;
+            sd += lo;
+            if (sd < lo)  // Перенос
+                duty++;
+        }
         setDuty (duty);
     }
 
+    /*********************************************************************
+     * @fn      setDutyQ16
+     *
+     * @brief   Заполнение долей периода, не зависит от ARR
+     *
+     * @param   q - 0..65536 (65536 = 100%)
+     *
+     * @return  none
+     */
+    void setDutyQ16 (uint32_t q) {
+        if (q > 65536)
+            q = 65536;
+        setDutyFine (pwmMul (q, arr));  // q * arr < 2^32 при arr < 65536
+    }
+
+    /*********************************************************************
+     * @fn      setDutyPermille
+     *
+     * @brief   Заполнение в десятых долях процента
+     *
+     * @param   permille - 0..1000
+     *
+     * @return  none
+     *
+     * @note    permille * 65536 / 1000 ~ permille * 8389 >> 7, без деления
+     */
+    void setDutyPermille (uint16_t permille) {
+        if (permille > 1000)
+            permille = 1000;
+        setDutyQ16 (pwmMul (8389, permille) >> 7);
+    }
+
     /*********************************************************************
      * @fn      setPrescaler
      *
@@ -131,7 +384,7 @@ class Pwm {
         psc = prescaler;
         // TIM_PSCReloadMode_Immediate - применить сразу (может быть глитч)
         // TIM_PSCReloadMode_Update - применить при след. обновлении (плавно)
-        TIM_PrescalerConfig (TIM1, prescaler, TIM_PSCReloadMode_Update);
+        tim()->PSC = prescaler;
     }
 
     /*********************************************************************
@@ -149,20 +402,13 @@ class Pwm {
      *          setFrequency(10000)    -> 10 kHz
      *          setFrequency(80000)    -> 80 kHz (максимум при ARR=100)
      *          setFrequency(20)       -> 20 Hz (низкая частота)
+     *          Считает PSC делением; для известных заранее частот
+     *          дешевле apply (pwmTiming (f), percent)
      */
     void setFrequency (uint32_t freq_hz, uint32_t f_cpu = 8000000) {
-        if (freq_hz == 0)
-            freq_hz = 1;
-
         // Формула: freq = F_CPU / ((PSC+1) * ARR)
         // PSC = (F_CPU / (freq * ARR)) - 1
-        uint32_t prescaler = (f_cpu / (freq_hz * arr)) - 1;
-
-        // Ограничение диапазона
-        if (prescaler > 65535)
-            prescaler = 65535;
-
-        setPrescaler ((uint16_t)prescaler);
+        setPrescaler ((uint16_t)pwmPsc (freq_hz ? freq_hz : 1, arr, f_cpu));
     }
 
     /*********************************************************************
@@ -175,21 +421,22 @@ class Pwm {
      * @return  none
      *
      * @note    При изменении ARR автоматически корректируется duty cycle,
-     *          чтобы сохранить процентное соотношение
+     *          чтобы сохранить процентное соотношение (последнее заданное
+     *          в процентах). Одно деление - на пересчёт коэффициента k
      */
     void setPeriod (uint16_t period) {
         if (period == 0)
             period = 1;
 
-        // Сохраняем процентное соотношение duty cycle
-        uint8_t duty_percent = (ccp * 100) / arr;
-
+        // ARR и CCR должны примениться в одном событии обновления
+        lock();
         arr = period;
-        TIM1->ATRLR = arr - 1;  // Записываем новый ARR
+        k = pwmDutyK (arr);
+        tim()->ATRLR = arr - 1;  // Записываем новый ARR
 
         // Пересчитываем duty с учётом нового периода
-        uint16_t new_duty = (arr * duty_percent) / 100;
-        setDuty (new_duty);
+        setDuty (pwmScale (pct, k));
+        unlock();
     }
 
     /*********************************************************************
@@ -226,8 +473,10 @@ class Pwm {
                 resolution = 1;
         }
 
+        lock();
         setPeriod (resolution);
         setPrescaler ((uint16_t)prescaler);
+        unlock();
     }
 
     /*********************************************************************
@@ -243,36 +492,106 @@ class Pwm {
         return f_cpu / ((psc + 1) * arr);
     }
 
+    /*********************************************************************
+     * @fn      setRepetition
+     *
+     * @brief   Запись счётчика повторений (RCR)
+     *
+     * @param   rep - 0..255, событие обновления будет раз в rep+1 периодов
+     *                (только TIM1, у TIM2 счётчика повторений нет)
+     *
+     * @return  none
+     *
+     * @note    RCR буферизован, как PSC и CCR: новое значение вступит в силу
+     *          на следующем событии обновления (или сразу после update())
+     */
+    void setRepetition (uint8_t rep) {
+        if (isTim1)
+            tim()->RPTCR = rep;
+    }
+
+    /*********************************************************************
+     * @fn      update
+     *
+     * @brief   Программное событие обновления (UG)
+     *
+     * @return  none
+     *
+     * @note    Переносит PSC/ARR/CCR/RCR из предзагрузки в рабочие регистры
+     *          и обнуляет счётчик. UIF при этом не ставится (URS = 1)
+     */
+    void update() {
+        tim()->SWEVGR = TIM_UG;
+        tim()->INTFR = (uint16_t)~TIM_UIF;
+    }
+
+    /*********************************************************************
+     * @fn      isUpdated
+     *
+     * @brief   Проверка и сброс флага события обновления (UIF)
+     *
+     * @return  1 - было событие обновления с прошлого вызова
+     */
+    uint8_t isUpdated() {
+        if ((tim()->INTFR & TIM_UIF) == 0)
+            return 0;
+        tim()->INTFR = (uint16_t)~TIM_UIF;
+        return 1;
+    }
+
+    /*********************************************************************
+     * @fn      enable
+     *
+     * @brief   Вернуть канал в PWM Mode 1 и включить MOE (TIM1)
+     *
+     * @return  none
+     *
+     * @note    Таймер не останавливается и вывод остаётся в AF, поэтому это
+     *          пара записей в регистры. Счётчик продолжает идти с места, для
+     *          старта с начала периода вызвать update()
+     *          BDTR - чтение-изменение-запись: если MOE может снять
+     *          прерывание (защита), вызывать с этим прерыванием выключенным
+     */
     void enable() {
-       
-        if (TIM1->CTLR1 & TIM_CEN) return;
-
-        // 1) Вернуть PA2 в режим AF_PP (для TIM1_CH2N)
-        GPIO_InitTypeDef gpio;
-        gpio.GPIO_Pin = GPIO_Pin_2;
-        gpio.GPIO_Mode = GPIO_Mode_AF_PP;
-        gpio.GPIO_Speed = GPIO_Speed_30MHz;
-        GPIO_Init (GPIOA, &gpio);
-
-        TIM_CtrlPWMOutputs (TIM1, ENABLE);
-        TIM_Cmd (TIM1, ENABLE);
+        chctlr() = (chctlr() & ~(TIM_OC1M << CH_SHIFT)) | ((TIM_OC1M_2 | TIM_OC1M_1) << CH_SHIFT);
+        if (isTim1)
+            tim()->BDTR |= TIM_MOE;
     }
 
+    /*********************************************************************
+     * @fn      disable
+     *
+     * @brief   Припарковать выход в LOW
+     *
+     * @return  none
+     *
+     * @note    OCxM = 100 (принудительно неактивный) и MOE = 0 (TIM1, выход
+     *          уходит в уровень покоя OISx = LOW при OSSI = 1). Таймер
+     *          продолжает считать, мультиплексор вывода не трогаем
+     */
     void disable() {
+        if (isTim1)
+            tim()->BDTR &= (uint16_t)~TIM_MOE;
+        chctlr() = (chctlr() & ~(TIM_OC1M << CH_SHIFT)) | (TIM_OC1M_2 << CH_SHIFT);
+    }
 
-         if ((TIM1->CTLR1 & TIM_CEN) == 0) return;
+  private:
+    uint8_t locks = 0;
+    uint16_t sd = 0;  // Аккумулятор сигма-дельты
 
-        TIM_CtrlPWMOutputs (TIM1, DISABLE);
-        TIM_Cmd (TIM1, DISABLE);
+    // UDIS: пока установлен, событие обновления не переносит предзагрузку
+    void lock() {
+        if (locks++ == 0)
+            tim()->CTLR1 |= TIM_UDIS;
+    }
 
-        // Переводим PA2 в обычный GPIO и устанавливаем LOW
-        GPIO_InitTypeDef gpio;
-        gpio.GPIO_Pin = GPIO_Pin_2;
-        gpio.GPIO_Mode = GPIO_Mode_Out_PP;
-        gpio.GPIO_Speed = GPIO_Speed_10MHz;
-        GPIO_Init (GPIOA, &gpio);
-        GPIO_WriteBit (GPIOA, GPIO_Pin_2, Bit_RESET);
+    void unlock() {
+        if (--locks == 0)
+            tim()->CTLR1 &= (uint16_t)~TIM_UDIS;
     }
 };
 
+/* Мотор: TIM1 CH2N на PA2, CH1 - запуск АЦП тока в середине импульса */
+typedef PwmT<TIM1_BASE, 2, true, GPIOA_BASE, 2, 1> Pwm;
+
 #endif  // __cplusplus
\ No newline at end of file
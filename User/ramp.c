@@ -0,0 +1,94 @@
+#include <debug.h>
+
+/*
+ * Плавный разгон/останов: CCR от from до to за time_ms по форме кривой.
+ * Шаг - из Motor_Tick (1 кГц), главный цикл не участвует.
+ * Кривые - таблицы 33 точки в Q15 во флеше (по 66 байт), между точками
+ * линейная интерполяция. Деление одно - на 1 / time_ms при старте.
+ */
+
+#define RAMP_SEG_SH 11  // 32 отрезка на Q16: индекс = x >> 11
+
+// S-кривая: y = 3x^2 - 2x^3
+static const uint16_t ramp_scurve[33] = {
+        0,    94,   368,   810,  1408,  2150,  3024,  4018,
+     5120,  6318,  7600,  8954, 10368, 11830, 13328, 14850,
+    16384, 17917, 19439, 20937, 22399, 23813, 25167, 26449,
+    27647, 28749, 29743, 30617, 31359, 31957, 32399, 32673,
+    32767,
+};
+
+// Экспонента: y = (1 - e^(-4x)) / (1 - e^(-4)) - быстро в начале, мягко в конце
+static const uint16_t ramp_exp[33] = {
+        0,  3922,  7383, 10438, 13133, 15512, 17612, 19464,
+    21099, 22542, 23815, 24939, 25931, 26806, 27578, 28260,
+    28861, 29392, 29860, 30274, 30638, 30960, 31245, 31495,
+    31717, 31912, 32084, 32236, 32370, 32489, 32593, 32686,
+    32767,
+};
+
+// Форма кривой: x - Q16 (0..65535), результат Q15 (0..32767)
+static uint16_t Ramp_Shape (uint8_t shape, uint32_t x) {
+    const uint16_t *t;
+
+    if (shape == RAMP_SCURVE)
+        t = ramp_scurve;
+    else if (shape == RAMP_EXP)
+        t = ramp_exp;
+    else
+        return x >> 1;  // RAMP_LINEAR
+
+    uint8_t i = x >> RAMP_SEG_SH;
+    uint16_t frac = x & ((1 << RAMP_SEG_SH) - 1);
+
+    return t[i] + (((int32_t)(t[i + 1] - t[i]) * frac) >> RAMP_SEG_SH);
+}
+
+/*********************************************************************
+ * @fn      Ramp_Start
+ *
+ * @brief   Запустить рампу
+ *
+ * @param   from, to - CCR в начале и в конце
+ *          time_ms  - длительность, 0 - сразу to
+ *          shape    - RAMP_LINEAR / RAMP_SCURVE / RAMP_EXP
+ *
+ * @return  none
+ */
+void Ramp_Start (Ramp_t *r, uint16_t from, uint16_t to, uint16_t time_ms, uint8_t shape) {
+    r->from = from;
+    r->to = to;
+    r->ms = 0;
+    r->time_ms = time_ms;
+    r->k = time_ms ? 65536UL / time_ms : 0;
+    r->shape = shape;
+}
+
+/*********************************************************************
+ * @fn      Ramp_Step
+ *
+ * @brief   Следующий шаг (1 мс)
+ *
+ * @return  CCR для этого шага
+ */
+uint16_t Ramp_Step (Ramp_t *r) {
+    if (r->ms >= r->time_ms)
+        return r->to;
+
+    r->ms++;
+    uint32_t x = r->ms * r->k;  // Q16
+    if (x > 65535)
+        x = 65535;
+
+    int32_t d = (int32_t)r->to - r->from;
+    return r->from + ((d * Ramp_Shape (r->shape, x)) >> 15);
+}
+
+/*********************************************************************
+ * @fn      Ramp_Done
+ *
+ * @return  1 - рампа дошла до конца
+ */
+uint8_t Ramp_Done (const Ramp_t *r) {
+    return r->ms >= r->time_ms;
+}
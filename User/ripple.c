@@ -0,0 +1,109 @@
+#include <debug.h>
+
+/*
+ * Обороты без датчика - по коллекторным пульсациям тока.
+ * Отсчёты тока приходят раз в период ШИМ через Current_Next, обрабатываются
+ * в Motor_Tick. Сдвиги фильтров и RIPPLE_RPM_MAX рассчитаны на fs = 5 кГц:
+ * в RUNNING ШИМ всегда MOTOR_RUN_HZ (Motor_EnterRunning).
+ *
+ * Полосовой фильтр - разность двух экспоненциальных средних на сдвигах
+ * (без умножения, ядро RV32EC), состояние в Q4:
+ *   fast: a = 3/4   - срез сверху ~1.1 кГц при fs = 5 кГц
+ *   slow: a = 1/32  - уход постоянной составляющей, ~25 Гц
+ * Предел - Найквист: 2500 Гц = 25000 об/мин при 6 пульсациях на оборот.
+ * Счёт пиков надёжен до ~fs/5 (5 отсчётов на пульсацию): 1000 Гц =
+ * RIPPLE_RPM_MAX (debug.h), выше пики теряются и оценка занижена.
+ * Без тахо maxRpm (eeprom.hpp) ограничен этим значением.
+ * Пики считаются по переходам через +-порог с гистерезисом, порог -
+ * половина огибающей |y|. Всё состояние - 16 байт ОЗУ.
+ */
+
+#define RIPPLE_FAST_SH   2    // a = 1 - 1/4
+#define RIPPLE_SLOW_SH   5    // a = 1/32
+#define RIPPLE_ENV_SH    4    // Огибающая, a = 1/16
+#define RIPPLE_MIN_ENV   (2 << 4)  // Меньше 2 LSB - это шум, а не пульсации
+
+// об/мин = пиков в окне * 60000 / (окно * пульсаций на оборот)
+#define RIPPLE_RPM_PER_PEAK (60000 / (RIPPLE_WINDOW_MS * RIPPLE_PER_REV))
+
+static int32_t rp_fast;     // Q4
+static int32_t rp_slow;     // Q4
+static int16_t rp_env;      // Q4, огибающая |y|
+static uint8_t rp_high;     // Гистерезис: последний переход был вверх
+static uint8_t rp_ms;       // Тиков в текущем окне
+static uint16_t rp_peaks;   // Пиков в текущем окне
+static uint16_t rp_rpm;     // Результат последнего окна
+
+/*********************************************************************
+ * @fn      Ripple_Reset
+ *
+ * @brief   Сброс оценки (старт/стоп мотора)
+ *
+ * @return  none
+ */
+void Ripple_Reset (void) {
+    uint16_t x = Current_Last();  // Кольцо может быть уже вычитано - тогда он
+
+    while (Current_Next (&x))  // Пропустить накопленные отсчёты
+        ;
+
+    rp_fast = rp_slow = (int32_t)x << 4;
+    rp_env = 0;
+    rp_high = 0;
+    rp_ms = 0;
+    rp_peaks = 0;
+    rp_rpm = 0;
+}
+
+/*********************************************************************
+ * @fn      Ripple_Tick
+ *
+ * @brief   Обработать новые отсчёты тока. Вызывается раз в 1 мс
+ *
+ * @return  1 - окно закончилось, Ripple_GetRpm обновился
+ */
+uint8_t Ripple_Tick (void) {
+    uint16_t x;
+
+    while (Current_Next (&x)) {
+        int32_t q = (int32_t)x << 4;
+
+        int32_t d = q - rp_fast;
+        rp_fast += d - (d >> RIPPLE_FAST_SH);
+        rp_slow += (q - rp_slow) >> RIPPLE_SLOW_SH;
+
+        int16_t y = (int16_t)(rp_fast - rp_slow);
+        int16_t a = (y < 0) ? -y : y;
+        rp_env += (a - rp_env) >> RIPPLE_ENV_SH;
+
+        if (rp_env < RIPPLE_MIN_ENV)
+            continue;
+
+        int16_t th = rp_env >> 1;
+        if (!rp_high && y > th) {
+            rp_high = 1;
+            rp_peaks++;
+        } else if (rp_high && y < -th) {
+            rp_high = 0;
+        }
+    }
+
+    if (++rp_ms >= RIPPLE_WINDOW_MS) {
+        rp_rpm = rp_peaks * RIPPLE_RPM_PER_PEAK;
+        rp_peaks = 0;
+        rp_ms = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      Ripple_GetRpm
+ *
+ * @brief   Обороты за последнее окно
+ *
+ * @return  об/мин (шаг 100 об/мин при окне 100 мс и 6 пульсациях)
+ */
+uint16_t Ripple_GetRpm (void) {
+    return rp_rpm;
+}
@@ -10,11 +10,6 @@
 extern uButton b;
 extern Screen screen;
 
-extern uEeprom eeprom_power;
-extern uEeprom eeprom_boostEnable;
-extern uEeprom eeprom_boostPower;
-extern uEeprom eeprom_boostTime;
-
 void status (int step);
 void exit (void);
 
@@ -30,6 +25,7 @@ void beep (int value) {
         // buzzer_click();
 
         buzzer_warning();
+        Buzzer_Wait();
         LED_OFF;
         delay (200);
     }
@@ -38,6 +34,16 @@ void beep (int value) {
 void ScreenNormal (void) {
 
     static int step = 0;
+    static int fault = 0;
+
+    // Авария по току: один сигнал, сброс - нажатием кнопки (Motor_Toggle -> STOP)
+    if (Motor_isFault()) {
+        if (!fault)
+            buzzer_error();
+        fault = 1;
+    } else {
+        fault = 0;
+    }
 
     if (Motor_isStop()) {
         LED_OFF;
@@ -104,6 +110,7 @@ void ScreenNormal (void) {
             buzzer_shutdown();
             buzzer_shutdown();
             buzzer_shutdown();
+            Buzzer_Wait();
 
             __disable_irq();  // отключаем все прерывания
             NVIC_SystemReset();
@@ -120,8 +127,8 @@ void ScreenNormal (void) {
     }
 }
 
-void uniScreen (uEeprom *eeprom, char *title, uint8_t div) {
-    int imp = eeprom->get() / div;
+void uniScreen (uEeprom eeprom, char *title, uint8_t div) {
+    int imp = eeprom.get() / div;
     if (b.click()) {
         printf ("Click\r\n");
         buzzer_ios_click();
@@ -138,7 +145,7 @@ void uniScreen (uEeprom *eeprom, char *title, uint8_t div) {
             } else {
                 buzzer_click();
             }
-            eeprom->set (imp * div);
+            eeprom.set (imp * div);
             printf ("++ Clicks: %d imp:%d\r\n", b.getClicks(), imp);
         }
 
@@ -157,7 +164,7 @@ void uniScreen (uEeprom *eeprom, char *title, uint8_t div) {
             } else {
                 beep_Decrement_Min();
             }
-            eeprom->set (imp * div);
+            eeprom.set (imp * div);
             printf ("-- Clicks: %d imp:%d\r\n", b.getClicks(), imp);
         }
 
@@ -168,6 +175,7 @@ void uniScreen (uEeprom *eeprom, char *title, uint8_t div) {
             for (int i = 0; i < imp; i++) {
                 LED_ON;
                 buzzer_beepboop();
+                Buzzer_Wait();
                 LED_OFF;
                 delay (300);
             }
@@ -177,13 +185,13 @@ void uniScreen (uEeprom *eeprom, char *title, uint8_t div) {
         if (b.getClicks() == 5) {
             beep_Save();
             beep_Save();
-            eeprom->save();
+            userEEPROMSave();  // Вместе с остальными изменёнными настройками
         }
     }
 }
 
 void ScreenPower() {
-    uniScreen (&eeprom_power, (char *)"ScreenPower", 5);
+    uniScreen (uEeprom::of<CfgPower>(), (char *)"ScreenPower", 5);
 }
 
 void ScreenBoostEnable (void) {
@@ -220,18 +228,18 @@ void ScreenBoostEnable (void) {
         if (b.getClicks() == 5) {
             beep_Save();
             beep_Save();
-            eeprom_boostEnable.save();
+            userEEPROMSave();
         }
     }
 }
 
 void ScreenBoostPower (void) {
-    uniScreen (&eeprom_boostPower, (char *)"ScreenBoostPower", 5);
+    uniScreen (uEeprom::of<CfgBoostPower>(), (char *)"ScreenBoostPower", 5);
 }
 
 // configBoostTime;     // Время буста в ms  1-импульс 50ms 1..20 50..1000
 void ScreenBoostTime() {
-    uniScreen (&eeprom_boostTime, (char *)"ScreenBoostTime", 50);
+    uniScreen (uEeprom::of<CfgBoostTime>(), (char *)"ScreenBoostTime", 50);
 }
 
 void status (int step) {
@@ -0,0 +1,47 @@
+#include <debug.h>
+
+volatile uint32_t millisec = 0;
+
+/*********************************************************************
+ * @fn      SysTime_Init
+ *
+ * @brief   SysTick: HCLK/8, автоперезагрузка, прерывание раз в 1 мс
+ *
+ * @return  none
+ */
+void SysTime_Init (void) {
+    if (SysTick->CTLR & 1)
+        return;  // Уже запущен - не сбивать ход времени
+
+    SysTick->SR &= ~(1 << 0);
+    SysTick->CMP = SystemCoreClock / 8000 - 1;
+    SysTick->CNT = 0;
+    SysTick->CTLR = 0xb;  // STE | STIE | STRE, такт HCLK/8
+
+    NVIC_SetPriority (SysTick_IRQn, 1 << 7);  // Вытеснение 1: защиты по току важнее
+    NVIC_EnableIRQ (SysTick_IRQn);
+}
+
+/*********************************************************************
+ * @fn      now_us
+ *
+ * @brief   Время в микросекундах: millisec * 1000 + SysTick->CNT
+ *
+ * @return  мкс с момента запуска (по модулю 2^32)
+ */
+uint32_t now_us (void) {
+    uint32_t ms, cnt;
+
+    do {
+        ms = millisec;
+        cnt = SysTick->CNT;
+    } while (ms != millisec);  // Прерывание SysTick успело отработать - перечитать
+
+    // Счётчик уже перешёл через CMP, а прерывание ещё не отработало
+    // (вызов из другого прерывания или при запрещённых прерываниях)
+    if ((SysTick->SR & 1) && cnt < 500)
+        ms++;
+
+    // ms * 1000 без аппаратного умножения: 1024 - 16 - 8
+    return (ms << 10) - (ms << 4) - (ms << 3) + cnt;
+}
@@ -0,0 +1,48 @@
+#ifndef __SYSTIME_H
+#define __SYSTIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Системное время. SysTick тактируется HCLK/8 = 1 МГц (SYSCLK 8 МГц),
+// прерывание раз в 1 мс. Счётчик 32-битный: читается одной инструкцией,
+// переполняется раз в ~49 дней, поэтому сравнивать только через разность.
+// SysTick никто, кроме SysTime_Init(), не перенастраивает: все задержки -
+// ожидание момента по свободно бегущему счётчику.
+
+extern volatile uint32_t millisec;
+
+// Настроить SysTick (единственное место, где он программируется)
+extern void SysTime_Init (void);
+
+// Текущее время, мс
+static inline uint32_t now_ms (void) {
+    return millisec;
+}
+
+// Сколько мс прошло с момента since
+static inline uint32_t elapsed_ms (uint32_t since) {
+    return millisec - since;
+}
+
+// Наступил ли момент deadline (например now_ms() + 100)
+static inline int deadline_reached (uint32_t deadline) {
+    return (int32_t)(millisec - deadline) >= 0;
+}
+
+// Текущее время, мкс (переполнение раз в ~71 минуту)
+extern uint32_t now_us (void);
+
+// Сколько мкс прошло с момента since
+static inline uint32_t elapsed_us (uint32_t since) {
+    return now_us() - since;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYSTIME_H */
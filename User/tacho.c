@@ -0,0 +1,172 @@
+#include <debug.h>
+
+/*
+ * Тахо/Холл на PD3 = TIM2_CH2 (тот же Partial Remap 2, что у зуммера).
+ * Фронт защёлкивается в CCR2 аппаратно, процессор ничего не опрашивает.
+ *
+ * TIM2 принадлежит зуммеру: такт 1 МГц, но ARR меняется от ноты к ноте,
+ * поэтому CCR2 - время фронта только внутри текущего периода таймера.
+ * В прерывании CC2 переводим его в абсолютное время:
+ *   t = now_us() - ((CNT - CCR2) mod (ARR + 1))
+ * Прерывание TIM2 с приоритетом вытеснения 0 успевает задолго до конца
+ * периода (самая высокая нота ~250 мкс, тишина - 65 мс). Ошибка возможна,
+ * только если UG новой ноты попал между захватом и входом в прерывание -
+ * окно в единицы тактов, кольцо периодов его сглаживает.
+ */
+
+#define TACHO_PULSES_PER_REV 1       // Импульсов датчика на оборот
+#define TACHO_RING_LEN       8       // Степень двойки: среднее = сумма >> 3
+#define TACHO_STALL_US       500000  // Нет фронтов дольше - мотор стоит
+#define TACHO_MIN_PERIOD_US  100     // Короче - дребезг, пропускаем
+
+static volatile uint32_t tacho_ring[TACHO_RING_LEN];  // Периоды, мкс
+static volatile uint8_t tacho_head = 0;               // Счётчик записанных периодов
+static volatile uint8_t tacho_fill = 0;               // Периодов в кольце, 0..LEN
+static volatile uint8_t tacho_edge = 0;               // Был фронт после Tacho_Reset
+static volatile uint32_t tacho_last = 0;              // Время последнего фронта, мкс
+
+static uint8_t tacho_seen = 0;   // tacho_head на момент расчёта tacho_rpm
+static uint8_t tacho_ticked = 0; // tacho_head на прошлом Tacho_Tick
+static uint16_t tacho_rpm = 0;
+
+/*********************************************************************
+ * @fn      Tacho_Init
+ *
+ * @brief   PD3 вход с подтяжкой, TIM2 CH2 захват по спаду, прерывание CC2
+ *
+ * @return  none
+ *
+ * @note    Вызывать после Buzzer_Init - таймер настраивает зуммер
+ */
+void Tacho_Init (void) {
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    TIM_ICInitTypeDef TIM_ICInitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    RCC_APB2PeriphClockCmd (RCC_APB2Periph_GPIOD | RCC_APB2Periph_AFIO, ENABLE);
+    GPIO_PinRemapConfig (GPIO_PartialRemap2_TIM2, ENABLE);  // PD3 -> TIM2_CH2
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_3;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;  // Открытый коллектор датчика
+    GPIO_Init (GPIOD, &GPIO_InitStructure);
+
+    TIM_ICInitStructure.TIM_Channel = TIM_Channel_2;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_Falling;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = 0x6;  // ~6 мкс при 8 МГц - против дребезга
+    TIM_ICInit (TIM2, &TIM_ICInitStructure);
+
+    TIM_ClearITPendingBit (TIM2, TIM_IT_CC2);
+    TIM_ITConfig (TIM2, TIM_IT_CC2, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init (&NVIC_InitStructure);
+
+    Tacho_Reset();
+}
+
+/*********************************************************************
+ * @fn      Tacho_Reset
+ *
+ * @brief   Очистить кольцо. Отсчёт остановки начинается заново
+ *
+ * @return  none
+ */
+void Tacho_Reset (void) {
+    NVIC_DisableIRQ (TIM2_IRQn);
+    tacho_head = 0;  // Кольцо заново с ячейки 0: Tacho_GetRpm суммирует [0, fill)
+    tacho_fill = 0;
+    tacho_edge = 0;
+    tacho_last = now_us();
+    tacho_seen = 0;
+    tacho_ticked = 0;
+    tacho_rpm = 0;
+    NVIC_EnableIRQ (TIM2_IRQn);
+}
+
+/*********************************************************************
+ * @fn      Tacho_Capture
+ *
+ * @brief   Фронт датчика. Вызывается из TIM2_IRQHandler
+ *
+ * @return  none
+ */
+void Tacho_Capture (void) {
+    uint16_t ccr = TIM2->CH2CVR;  // Чтение сбрасывает CC2IF
+    uint16_t cnt = TIM2->CNT;
+    uint32_t top = (uint32_t)TIM2->ATRLR + 1;
+    uint32_t age = (cnt >= ccr) ? (uint32_t)(cnt - ccr) : cnt + top - ccr;
+    uint32_t t = now_us() - age;
+
+    if (tacho_edge) {
+        uint32_t p = t - tacho_last;
+        if (p < TACHO_MIN_PERIOD_US)
+            return;  // Дребезг: фронт не считаем
+        tacho_ring[tacho_head & (TACHO_RING_LEN - 1)] = p;
+        tacho_head++;
+        if (tacho_fill < TACHO_RING_LEN)
+            tacho_fill++;
+    }
+    tacho_last = t;
+    tacho_edge = 1;
+}
+
+/*********************************************************************
+ * @fn      Tacho_Tick
+ *
+ * @brief   Пришёл ли новый период с прошлого вызова (шаг ПИ по тахо)
+ *
+ * @return  1 - Tacho_GetRpm даст новое значение
+ */
+uint8_t Tacho_Tick (void) {
+    uint8_t head = tacho_head;
+    uint8_t fresh = head != tacho_ticked;
+
+    tacho_ticked = head;
+    return fresh;
+}
+
+/*********************************************************************
+ * @fn      Tacho_IsStalled
+ *
+ * @brief   Фронтов не было дольше TACHO_STALL_US
+ *
+ * @return  1 - мотор стоит
+ */
+uint8_t Tacho_IsStalled (void) {
+    return elapsed_us (tacho_last) > TACHO_STALL_US;
+}
+
+/*********************************************************************
+ * @fn      Tacho_GetRpm
+ *
+ * @brief   Обороты по среднему периоду кольца
+ *
+ * @return  об/мин, 0 - стоит или ещё нет двух фронтов
+ *
+ * @note    Деление - только когда пришёл новый период
+ */
+uint16_t Tacho_GetRpm (void) {
+    if (Tacho_IsStalled())
+        return 0;
+
+    uint8_t head = tacho_head;
+    uint8_t fill = tacho_fill;
+    if (head == tacho_seen || fill == 0)
+        return tacho_rpm;
+    tacho_seen = head;
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < fill; i++)
+        sum += tacho_ring[i];
+
+    uint32_t period = (fill == TACHO_RING_LEN) ? sum >> 3 : sum / fill;
+    uint32_t rpm = 60000000UL / (period * TACHO_PULSES_PER_REV);
+    tacho_rpm = (rpm > 65535) ? 65535 : rpm;
+
+    return tacho_rpm;
+}
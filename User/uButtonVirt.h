@@ -2,7 +2,7 @@
 
 #ifdef __cplusplus
 
-extern uint64_t millisec;
+#include "systime.h"
 
 //#include "define.h"
 
@@ -280,7 +280,7 @@ class uButtonVirt {
     // кнопка нажата в прерывании
     void pressISR() {
         _press = 1;
-        _deb = millisec;
+        _deb = now_ms();
     }
 
     // обработка с антидребезгом. Вернёт true при смене состояния
@@ -288,8 +288,8 @@ class uButtonVirt {
         if (_press == pressed) {
             _deb = 0;
         } else {
-            if (!_deb) _deb = millisec;
-            else if ((millisec - _deb) >= UB_DEB_TIME) _press = pressed;
+            if (!_deb) _deb = now_ms();
+            else if (elapsed_ms(_deb) >= UB_DEB_TIME) _press = pressed;
         }
         return poll(_press);
     }
@@ -385,18 +385,18 @@ class uButtonVirt {
     }
 
    private:
-    int64_t _tmr = 0;
-    int64_t  _deb = 0;
+    uint32_t _tmr = 0;
+    uint32_t _deb = 0;
     uint8_t _press;
     uint8_t _steps;
     State _state;
     uint8_t _clicks;
 
-    int64_t _getTime() {
-        return millisec - _tmr;
+    uint32_t _getTime() {
+        return elapsed_ms(_tmr);
     }
     void _resetTime() {
-        _tmr = millisec;
+        _tmr = now_ms();
     }
 };
 
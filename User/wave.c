@@ -0,0 +1,75 @@
+#include <debug.h>
+
+/*
+ * Воспроизведение огибающей заполнения из таблицы во флеше без процессора.
+ * Событие обновления TIM1 (раз в RCR + 1 периодов) - запрос DMA1 Channel5,
+ * DMA-пачка через DMAADR пишет две записи таблицы в CH1CVR и CH2CVR:
+ * точку запуска АЦП и само заполнение. Запуск АЦП остаётся в середине
+ * импульса - сторож тока во время воспроизведения работает как обычно.
+ *
+ * Channel1 занят АЦП (current.c), TIM1_UP по таблице запросов - Channel5.
+ * Значения - в тиках CCR текущего ARR, в таблицу писать через WAVE_PT.
+ */
+
+/*********************************************************************
+ * @fn      Wave_Play
+ *
+ * @brief   Запустить воспроизведение. TIM1 уже должен работать на нужном ARR
+ *
+ * @param   tab  - таблица WAVE_PT(ccr), ...
+ *          len  - число точек (не элементов массива)
+ *          hold - точка длится hold + 1 периодов ШИМ (RCR, 0..255)
+ *          loop - 1 - по кругу до Wave_Stop, 0 - один раз
+ *
+ * @return  none
+ */
+void Wave_Play (const uint16_t *tab, uint16_t len, uint8_t hold, uint8_t loop) {
+    DMA_InitTypeDef DMA_InitStructure = {0};
+
+    Wave_Stop();
+    RCC_AHBPeriphClockCmd (RCC_AHBPeriph_DMA1, ENABLE);
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&TIM1->DMAADR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tab;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = len * 2;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = loop ? DMA_Mode_Circular : DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;  // АЦП важнее
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init (DMA1_Channel5, &DMA_InitStructure);
+    DMA_ClearFlag (DMA1_FLAG_TC5);
+    DMA_Cmd (DMA1_Channel5, ENABLE);
+
+    // Пачка из двух записей с CH1CVR: CH1CVR, CH2CVR
+    TIM_DMAConfig (TIM1, TIM_DMABase_CCR1, TIM_DMABurstLength_2Transfers);
+    TIM1->RPTCR = hold;
+    TIM_DMACmd (TIM1, TIM_DMA_Update, ENABLE);
+}
+
+/*********************************************************************
+ * @fn      Wave_Stop
+ *
+ * @brief   Остановить воспроизведение. CCR остаются последними записанными
+ *
+ * @return  none
+ */
+void Wave_Stop (void) {
+    TIM_DMACmd (TIM1, TIM_DMA_Update, DISABLE);
+    DMA1_Channel5->CFGR &= ~DMA_CFGR1_EN;
+    TIM1->RPTCR = 0;
+}
+
+/*********************************************************************
+ * @fn      Wave_IsDone
+ *
+ * @brief   Однократное воспроизведение дошло до конца таблицы
+ *
+ * @return  1 - закончено (для loop = 1 - никогда)
+ */
+uint8_t Wave_IsDone (void) {
+    return DMA1_Channel5->CNTR == 0;
+}
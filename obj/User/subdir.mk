@@ -7,14 +7,30 @@
 C_SRCS += \
 ../User/buzzer.c \
 ../User/ch32v00x_it.c \
+../User/config.c \
+../User/current.c \
 ../User/init.c \
-../User/system_ch32v00x.c 
+../User/pi.c \
+../User/ramp.c \
+../User/ripple.c \
+../User/system_ch32v00x.c \
+../User/systime.c \
+../User/tacho.c \
+../User/wave.c 
 
 C_DEPS += \
 ./User/buzzer.d \
 ./User/ch32v00x_it.d \
+./User/config.d \
+./User/current.d \
 ./User/init.d \
-./User/system_ch32v00x.d 
+./User/pi.d \
+./User/ramp.d \
+./User/ripple.d \
+./User/system_ch32v00x.d \
+./User/systime.d \
+./User/tacho.d \
+./User/wave.d 
 
 CPP_SRCS += \
 ../User/main.cpp \
@@ -29,11 +45,19 @@ CPP_DEPS += \
 OBJS += \
 ./User/buzzer.o \
 ./User/ch32v00x_it.o \
+./User/config.o \
+./User/current.o \
 ./User/init.o \
 ./User/main.o \
 ./User/motor.o \
+./User/pi.o \
+./User/ramp.o \
+./User/ripple.o \
 ./User/screens.o \
-./User/system_ch32v00x.o 
+./User/system_ch32v00x.o \
+./User/systime.o \
+./User/tacho.o \
+./User/wave.o 
 
 DIR_OBJS += \
 ./User/*.o \
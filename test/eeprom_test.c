@@ -0,0 +1,122 @@
+/*
+ * EEPROM.c (эмуляция AN3969 с индексом в ОЗУ) на хосте, флеш - flash_sim.
+ * Две страницы по 1 КБ (стирание FLASH_ErasePage - 1 КБ). Случайные записи
+ * сверяются с моделью в ОЗУ:
+ *   - адреса 0..19 идут через индекс, 40..47 - выше EEPROM_INDEX_SIZE,
+ *     через просмотр страницы;
+ *   - каждые REINIT записей - новый дескриптор: через раз EEPROM_Init
+ *     (индекс строится заново), через раз без него (Active = 0, всё
+ *     просмотром страницы, как до EEPROM_Init);
+ *   - каждые 7 записей - чтение всех адресов, в конце - EEPROM_Count.
+ * В конце - чтение просмотром страницы против индекса: слотов на чтение
+ * (просмотр идёт с конца страницы до последней записи адреса) и время.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "eeprom_ch32v.h"
+#include "flash_sim.h"
+
+#define PAGE0   ((uint32_t)0x08003800)
+#define PAGE1   ((uint32_t)0x08003C00)
+#define WRITES  20000
+#define REINIT  101
+#define NADDR   48
+#define ROUNDS  2000    // Чтений каждого адреса при замере времени
+
+static uint16_t model[NADDR];
+static uint8_t has[NADDR];
+static int failures = 0;
+
+static uint16_t pick (void) {
+    return (rand() % 3 == 0) ? 40 + rand() % 8 : rand() % 20;
+}
+
+static void check_all (EEPROM_HandleTypeDef *h, int n) {
+    for (uint16_t a = 0; a < NADDR; a++) {
+        uint16_t d;
+        uint16_t r = EEPROM_Read (h, a, &d);
+        int ok = has[a] ? (r == EEPROM_OK && d == model[a]) : (r != EEPROM_OK);
+        if (!ok && failures++ < 10)
+            printf ("FAIL write %d: addr %u read %u (%u), expected %u (%s)\n", n, a, d, r, model[a], has[a] ? "set" : "unset");
+    }
+}
+
+// ns на чтение адресов 0..19 через дескриптор h
+static double read_ns (EEPROM_HandleTypeDef *h) {
+    uint16_t d;
+    clock_t t0 = clock();
+
+    for (int r = 0; r < ROUNDS; r++)
+        for (uint16_t a = 0; a < 20; a++)
+            EEPROM_Read (h, a, &d);
+    return (double)(clock() - t0) * 1e9 / CLOCKS_PER_SEC / (ROUNDS * 20);
+}
+
+// Просмотр страницы (дескриптор без EEPROM_Init) против индекса
+static void bench (void) {
+    EEPROM_HandleTypeDef idx = EEPROM_HANDLE_INIT (PAGE0, PAGE1, 1024);
+    EEPROM_HandleTypeDef scan = EEPROM_HANDLE_INIT (PAGE0, PAGE1, 1024);
+    uint32_t slots = 0;
+
+    EEPROM_Init (&idx);
+    scan.Status = EEPROM_OK;
+
+    // Просмотр: от последнего слота страницы до слота записи (номер - из индекса)
+    for (uint16_t a = 0; a < 20; a++)
+        slots += 1024 / 4 - idx.Index[a];
+
+    printf ("read bench: %u of %u slots used, addresses 0..19\n", idx.Free - 1, 1024 / 4 - 1);
+    printf ("  scan : %.1f slots/read, %.0f ns/read\n", slots / 20.0, read_ns (&scan));
+    printf ("  index: 1 slot/read, %.0f ns/read\n", read_ns (&idx));
+}
+
+int main (void) {
+    if (!flash_sim_map()) {
+        printf ("FAIL: cannot map flash window at 0x%08X\n", (unsigned)FLASH_SIM_BASE);
+        return 1;
+    }
+
+    EEPROM_HandleTypeDef h = EEPROM_HANDLE_INIT (PAGE0, PAGE1, 1024);
+    if (EEPROM_Init (&h) != EEPROM_OK) {
+        printf ("FAIL: EEPROM_Init on erased flash\n");
+        return 1;
+    }
+
+    srand (1);
+    for (int n = 1; n <= WRITES; n++) {
+        uint16_t a = pick();
+        uint16_t v = rand() & 0x7FFF;
+
+        if (EEPROM_Write (&h, a, v) != EEPROM_OK && failures++ < 10)
+            printf ("FAIL write %d: addr %u\n", n, a);
+        model[a] = v;
+        has[a] = 1;
+
+        if (n % REINIT == 0) {
+            EEPROM_HandleTypeDef fresh = EEPROM_HANDLE_INIT (PAGE0, PAGE1, 1024);
+            h = fresh;
+            if ((n / REINIT) & 1)
+                h.Status = EEPROM_OK;  // Без EEPROM_Init: индекса нет
+            else if (EEPROM_Init (&h) != EEPROM_OK && failures++ < 10)
+                printf ("FAIL write %d: EEPROM_Init\n", n);
+        }
+        if (n % 7 == 0)
+            check_all (&h, n);
+    }
+
+    uint16_t count, expect = 0;
+    for (uint16_t a = 0; a < NADDR; a++)
+        expect += has[a];
+    if (EEPROM_Count (&h, &count) != EEPROM_OK || count != expect) {
+        printf ("FAIL: EEPROM_Count %u, expected %u\n", count, expect);
+        failures++;
+    }
+
+    bench();
+
+    printf ("eeprom_test: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * FLASH_* на хосте (flash_sim.h)
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "flash_sim.h"
+
+#define SIM(addr) ((uint8_t *)(uintptr_t)(addr))
+
+jmp_buf flash_sim_cut;
+uint32_t flash_sim_ops = 0;
+uint32_t flash_sim_erases[FLASH_SIM_SIZE / FLASH_SIM_PAGE];
+
+static uint32_t page_buf[16];  // Буфер быстрой записи страницы 64 Б
+static long cut_at = -1;
+static uint32_t seed = 1;
+
+int flash_sim_map (void) {
+    void *base = SIM (FLASH_SIM_BASE);
+    void *p = mmap (base, FLASH_SIM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != base)
+        return 0;
+    flash_sim_erase_all();
+    return 1;
+}
+
+void flash_sim_erase_all (void) {
+    memset (SIM (FLASH_SIM_BASE), 0xFF, FLASH_SIM_SIZE);
+    memset (flash_sim_erases, 0, sizeof flash_sim_erases);
+    flash_sim_ops = 0;
+}
+
+void flash_sim_power_cut (long n) {
+    cut_at = n;
+}
+
+uint32_t flash_sim_rand (void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+void flash_sim_report (const char *name, uint32_t from, uint32_t to) {
+    uint32_t lo = UINT32_MAX, hi = 0;
+
+    printf ("%s: erases per 64 B page\n", name);
+    for (uint32_t a = from; a < to; a += FLASH_SIM_PAGE) {
+        uint32_t n = flash_sim_erases[(a - FLASH_SIM_BASE) / FLASH_SIM_PAGE];
+        if ((a - from) % 1024 == 0)
+            printf ("  0x%08X:", (unsigned)a);
+        printf (" %5u", (unsigned)n);
+        if ((a + FLASH_SIM_PAGE - from) % 1024 == 0 || a + FLASH_SIM_PAGE >= to)
+            printf ("\n");
+        if (n < lo)
+            lo = n;
+        if (n > hi)
+            hi = n;
+    }
+    printf ("  min %u, max %u\n", (unsigned)lo, (unsigned)hi);
+}
+
+static int in_sim (uint32_t addr, uint32_t size) {
+    return addr >= FLASH_SIM_BASE && addr + size <= FLASH_SIM_BASE + FLASH_SIM_SIZE;
+}
+
+// Операция записи или стирания: 1 - на ней пропадает питание
+static int cut_now (void) {
+    flash_sim_ops++;
+    if (cut_at < 0 || cut_at-- > 0)
+        return 0;
+    cut_at = -1;
+    return 1;
+}
+
+static void erase (uint32_t addr, uint32_t size) {
+    int cut = cut_now();
+
+    for (uint32_t a = addr; a < addr + size; a += FLASH_SIM_PAGE)
+        flash_sim_erases[(a - FLASH_SIM_BASE) / FLASH_SIM_PAGE]++;
+
+    if (cut) {
+        uint8_t *p = SIM (addr);
+        for (uint32_t i = 0; i < size; i++)
+            p[i] |= (uint8_t)flash_sim_rand();
+        longjmp (flash_sim_cut, 1);
+    }
+    memset (SIM (addr), 0xFF, size);
+}
+
+void FLASH_Unlock (void) {}
+void FLASH_Lock (void) {}
+void FLASH_Unlock_Fast (void) {}
+void FLASH_Lock_Fast (void) {}
+
+FLASH_Status FLASH_ErasePage (uint32_t Page_Address) {
+    Page_Address &= ~0x3FFu;
+    if (!in_sim (Page_Address, 1024))
+        return FLASH_ADR_RANGE_ERROR;
+    erase (Page_Address, 1024);
+    return FLASH_COMPLETE;
+}
+
+void FLASH_ErasePage_Fast (uint32_t Page_Address) {
+    Page_Address &= ~0x3Fu;
+    if (in_sim (Page_Address, FLASH_SIM_PAGE))
+        erase (Page_Address, FLASH_SIM_PAGE);
+}
+
+FLASH_Status FLASH_ProgramHalfWord (uint32_t Address, uint16_t Data) {
+    if (Address & 1)
+        return FLASH_ALIGN_ERROR;
+    if (!in_sim (Address, 2))
+        return FLASH_ADR_RANGE_ERROR;
+
+    uint16_t *p = (uint16_t *)SIM (Address);
+    if (cut_now()) {
+        *p &= Data | (uint16_t)flash_sim_rand();
+        longjmp (flash_sim_cut, 1);
+    }
+    *p &= Data;
+    return FLASH_COMPLETE;
+}
+
+void FLASH_BufReset (void) {
+    memset (page_buf, 0xFF, sizeof page_buf);
+}
+
+void FLASH_BufLoad (uint32_t Address, uint32_t Data0) {
+    page_buf[(Address & 0x3F) >> 2] = Data0;
+}
+
+void FLASH_ProgramPage_Fast (uint32_t Page_Address) {
+    Page_Address &= ~0x3Fu;
+    if (!in_sim (Page_Address, FLASH_SIM_PAGE))
+        return;
+
+    uint32_t *p = (uint32_t *)SIM (Page_Address);
+    if (cut_now()) {
+        uint32_t n = flash_sim_rand() % 16;
+        for (uint32_t i = 0; i < n; i++)
+            p[i] &= page_buf[i];
+        p[n] &= page_buf[n] | flash_sim_rand() | (flash_sim_rand() << 16);
+        longjmp (flash_sim_cut, 1);
+    }
+    for (int i = 0; i < 16; i++)
+        p[i] &= page_buf[i];
+}
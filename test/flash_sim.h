@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+ * Флеш CH32V003 на хосте: FLASH_* из ch32v00x_flash.h поверх ОЗУ,
+ * отображённого по настоящим адресам (последние 4 КБ: 0x08003000..0x08004000,
+ * там CFG_START и страницы эмуляции EEPROM). Код прошивки читает флеш
+ * напрямую по адресу, как на чипе.
+ *   Стирание: FLASH_ErasePage - 1 КБ, FLASH_ErasePage_Fast - 64 Б, в 0xFF.
+ *   Запись: только сброс битов (старое & новое), как у флеша.
+ *
+ * Отключение питания (flash_sim_power_cut): выбранная операция записи или
+ * стирания выполняется частично, затем longjmp (flash_sim_cut, 1):
+ *   - полуслово: сброшена случайная часть битов;
+ *   - быстрая запись страницы: слова по порядку, оборвана на случайном слове;
+ *   - стирание: случайная часть битов страницы поднята в 1.
+ * Счётчик стираний - на каждую страницу 64 Б (стирание 1 КБ - все 16).
+ */
+
+#include <setjmp.h>
+
+#include <debug.h>
+
+#define FLASH_SIM_BASE ((uint32_t)0x08003000)
+#define FLASH_SIM_SIZE 0x1000
+#define FLASH_SIM_PAGE 64
+
+extern jmp_buf flash_sim_cut;
+extern uint32_t flash_sim_ops;  // Операций записи и стирания с начала
+extern uint32_t flash_sim_erases[FLASH_SIM_SIZE / FLASH_SIM_PAGE];
+
+// Отобразить и стереть окно флеша. 0 - не вышло
+int flash_sim_map (void);
+
+// Стереть всё окно (как после прошивки с очисткой), счётчики - в 0
+void flash_sim_erase_all (void);
+
+// Питание пропадает на операции n (0 - ближайшая), n < 0 - не пропадает
+void flash_sim_power_cut (long n);
+
+// Псевдослучайное число (воспроизводимое, своё у модели и у теста)
+uint32_t flash_sim_rand (void);
+
+// Стирания страниц 64 Б в [from, to): по строке на 1 КБ, итог - min/max
+void flash_sim_report (const char *name, uint32_t from, uint32_t to);
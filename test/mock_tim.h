@@ -0,0 +1,128 @@
+#pragma once
+
+/*
+ * Подмена ch32v00x.h для PwmT на хосте.
+ * TIM_TypeDef с той же раскладкой, что у CH32V003, но регистры - классы
+ * Reg16/Reg32: каждая запись попадает в журнал mock_log, после записи
+ * вызывается mock_event() - модель события обновления таймера (переполнения),
+ * которое может прийти между любыми двумя записями.
+ * Периферия лежит по настоящим адресам (mock_map): PwmT берёт адрес из
+ * параметра шаблона.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define __IO volatile
+
+void mock_write (const volatile void *reg, uint32_t value);
+
+template <typename T>
+struct MockReg {
+    T v;
+
+    operator T() const { return v; }
+    MockReg &operator= (uint32_t x) {
+        v = (T)x;
+        mock_write (this, v);
+        return *this;
+    }
+    MockReg &operator|= (uint32_t x) { return *this = v | x; }
+    MockReg &operator&= (uint32_t x) { return *this = v & x; }
+};
+
+typedef MockReg<uint16_t> Reg16;
+typedef MockReg<uint32_t> Reg32;
+
+typedef struct {
+    Reg16 CTLR1;
+    uint16_t RESERVED0;
+    Reg16 CTLR2;
+    uint16_t RESERVED1;
+    Reg16 SMCFGR;
+    uint16_t RESERVED2;
+    Reg16 DMAINTENR;
+    uint16_t RESERVED3;
+    Reg16 INTFR;
+    uint16_t RESERVED4;
+    Reg16 SWEVGR;
+    uint16_t RESERVED5;
+    Reg16 CHCTLR1;
+    uint16_t RESERVED6;
+    Reg16 CHCTLR2;
+    uint16_t RESERVED7;
+    Reg16 CCER;
+    uint16_t RESERVED8;
+    Reg16 CNT;
+    uint16_t RESERVED9;
+    Reg16 PSC;
+    uint16_t RESERVED10;
+    Reg16 ATRLR;
+    uint16_t RESERVED11;
+    Reg16 RPTCR;
+    uint16_t RESERVED12;
+    Reg32 CH1CVR;
+    Reg32 CH2CVR;
+    Reg32 CH3CVR;
+    Reg32 CH4CVR;
+    Reg16 BDTR;
+    uint16_t RESERVED13;
+    Reg16 DMACFGR;
+    uint16_t RESERVED14;
+    Reg16 DMAADR;
+    uint16_t RESERVED15;
+} TIM_TypeDef;
+
+static_assert (offsetof (TIM_TypeDef, CH1CVR) == 0x34 && offsetof (TIM_TypeDef, BDTR) == 0x44,
+               "mock TIM_TypeDef layout differs from ch32v00x.h");
+
+typedef struct {
+    __IO uint32_t CFGLR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t APB2PCENR;
+    __IO uint32_t APB1PCENR;
+} RCC_TypeDef;
+
+extern RCC_TypeDef mock_rcc;
+#define RCC (&mock_rcc)
+
+#define PERIPH_BASE ((uint32_t)0x40000000)
+#define APB2PERIPH_BASE (PERIPH_BASE + 0x10000)
+#define TIM2_BASE (PERIPH_BASE + 0x0000)
+#define GPIOA_BASE (APB2PERIPH_BASE + 0x0800)
+#define GPIOC_BASE (APB2PERIPH_BASE + 0x1000)
+#define GPIOD_BASE (APB2PERIPH_BASE + 0x1400)
+#define TIM1_BASE (APB2PERIPH_BASE + 0x2C00)
+
+#define TIM1 ((TIM_TypeDef *)TIM1_BASE)
+
+#define RCC_APB2Periph_GPIOA ((uint32_t)0x00000004)
+#define RCC_APB2Periph_GPIOC ((uint32_t)0x00000010)
+#define RCC_APB2Periph_GPIOD ((uint32_t)0x00000020)
+#define RCC_APB2Periph_TIM1 ((uint32_t)0x00000800)
+#define RCC_APB1Periph_TIM2 ((uint32_t)0x00000001)
+
+#define TIM_CEN ((uint16_t)0x0001)
+#define TIM_UDIS ((uint16_t)0x0002)
+#define TIM_URS ((uint16_t)0x0004)
+#define TIM_ARPE ((uint16_t)0x0080)
+#define TIM_UIF ((uint16_t)0x0001)
+#define TIM_UG ((uint8_t)0x01)
+#define TIM_OC1PE ((uint16_t)0x0008)
+#define TIM_OC1M ((uint16_t)0x0070)
+#define TIM_OC1M_1 ((uint16_t)0x0020)
+#define TIM_OC1M_2 ((uint16_t)0x0040)
+#define TIM_CC1E ((uint16_t)0x0001)
+#define TIM_CC1NE ((uint16_t)0x0004)
+#define TIM_OSSI ((uint16_t)0x0400)
+#define TIM_MOE ((uint16_t)0x8000)
+
+// Отобразить память под GPIOA..TIM1 по адресам CH32V003. 0 - не вышло
+static inline int mock_map (void) {
+    void *base = (void *)(uintptr_t)APB2PERIPH_BASE;
+    void *p = mmap (base, 0x3000, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    return p == base;
+}
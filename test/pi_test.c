@@ -0,0 +1,110 @@
+/*
+ * pi.c на хосте: контур по оборотам, как в Motor_Tick (режим по оборотам
+ * без тахо), с моделью мотора первого порядка.
+ *   Мотор: обороты -> u * RPM_FREE с постоянной времени TAU_MS.
+ *   Измерение: как ripple.c - число пиков за окно RIPPLE_WINDOW_MS,
+ *   то есть среднее за окно с шагом 100 об/мин, обновляется раз в окно.
+ *   Тахо (tacho = 1): новое значение на каждый оборот (1 импульс), обороты
+ *   по последнему периоду - шаг ПИ через разное время.
+ *   Шаг ПИ - только по новому измерению, Ki и slew умножены на время
+ *   с прошлого шага (как pi_ms в Motor_Tick).
+ * Старт с места при заполнении разомкнутого режима (мотор с запасом:
+ * это на 17% выше уставки). Проверка: через 5 с ошибка не больше двух
+ * шагов измерения (без статической ошибки и раскачки), перерегулирование
+ * не больше 30%.
+ */
+
+#include <stdio.h>
+
+#include <debug.h>
+
+#define RPM_FREE 7000   // Обороты при 100% (maxRpm - с запасом)
+#define TAU_MS   150
+#define MAX_RPM  6000   // eeprom_maxRpm по умолчанию
+#define KP       8192   // eeprom_piKp по умолчанию
+#define KI       64     // eeprom_piKi по умолчанию, на 1 мс
+#define SLEW     (32767 / 200)
+#define PERIOD   RIPPLE_WINDOW_MS
+#define RPM_STEP (60000 / (RIPPLE_WINDOW_MS * RIPPLE_PER_REV))
+
+static int run (int power, int tacho, double *overshoot, double *final_err) {
+    Pi_t pi = {0};
+    pi.kp = KP;
+
+    int16_t sp = (int16_t)(power * 32767L / 100);
+    double target = (double)power * MAX_RPM / 100;
+    uint32_t rpm_k = (32768UL << 8) / MAX_RPM;
+
+    // Старт с разомкнутого: то же заполнение в процентах
+    Pi_Reset (&pi, sp);
+    int16_t u = sp;
+
+    double rpm = 0, sum = 0, peak = 0, err = 0, rev = 0;
+    uint32_t since = 0;
+    for (int ms = 1; ms <= 10000; ms++) {
+        rpm += ((double)u / 32767 * RPM_FREE - rpm) / TAU_MS;
+        sum += rpm;
+        rev += rpm / 60000;
+        since++;
+
+        int fresh;
+        uint16_t meas;
+        if (tacho) {
+            fresh = rev >= 1;  // Фронт датчика
+            meas = (uint16_t)(sum / since);  // Средняя за период
+            if (fresh)
+                rev -= 1;
+        } else {
+            fresh = ms % PERIOD == 0;
+            meas = (uint16_t)(sum / PERIOD / RPM_STEP) * RPM_STEP;
+        }
+
+        if (fresh) {
+            uint32_t ki = (uint32_t)KI * since;
+            uint32_t slew = (uint32_t)SLEW * since;
+            pi.ki = (ki > 32767) ? 32767 : ki;
+            pi.slew = (slew > 32767) ? 32767 : slew;
+            sum = 0;
+            since = 0;
+
+            uint32_t pv = ((uint32_t)meas * rpm_k) >> 8;
+            if (pv > 32767)
+                pv = 32767;
+            u = Pi_Step (&pi, sp, (int16_t)pv);
+        }
+
+        if (rpm > peak)
+            peak = rpm;
+        if (ms > 5000) {
+            double e = rpm - target;
+            if (e < 0)
+                e = -e;
+            if (e > err)
+                err = e;
+        }
+    }
+
+    *overshoot = (peak - target) / target;
+    *final_err = err;
+    return 0;
+}
+
+int main (void) {
+    int failures = 0;
+
+    // 100% не проверяется: уставка = maxRpm = потолок измерения в Q15
+    for (int tacho = 0; tacho <= 1; tacho++) {
+        for (int power = 20; power <= 80; power += 20) {
+            double os, fe;
+            run (power, tacho, &os, &fe);
+            if (os > 0.30 || fe > 2 * RPM_STEP) {
+                printf ("FAIL %s, power %d%%: overshoot %.1f%%, error after 5 s %.0f rpm\n",
+                        tacho ? "tacho" : "ripple", power, os * 100, fe);
+                failures++;
+            }
+        }
+    }
+
+    printf ("pi_test: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
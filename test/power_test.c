@@ -0,0 +1,278 @@
+/*
+ * Потеря питания при сохранении настроек, флеш - flash_sim.
+ * После каждого отключения - перезагрузка (сама может быть прервана ещё
+ * раз), затем чтение всех параметров. Каждый должен быть старым или новым
+ * значением, не мусором и не пропавшим.
+ *
+ *   config.c, перенос старого формата: отключение на каждой операции
+ *     переноса, затем второе на случайной. Все старые значения на месте.
+ *   config.c, журнал: одиночные Cfg_Write и пакеты Cfg_Stage + Cfg_Flush,
+ *     отключение в каждом четвёртом сохранении. Пакет - целиком старый
+ *     или целиком новый.
+ *   EEPROM.c: EEPROM_Write, две страницы по 1 КБ, так же.
+ * В конце каждого прогона - стирания по страницам 64 Б.
+ *
+ * config.c подключается исходником: перезагрузка обнуляет его static,
+ * как сброс ОЗУ.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../User/config.c"
+#include "eeprom_ch32v.h"
+#include "flash_sim.h"
+
+#define NID     12      // Параметров в журнале и в EEPROM
+#define SAVES   20000
+#define CUT_MAX 48      // Отключение - на одной из первых CUT_MAX операций
+#define EE_PAGE0 ((uint32_t)0x08003800)
+#define EE_PAGE1 ((uint32_t)0x08003C00)
+
+static int failures = 0;
+
+#define FAIL(...)                         \
+    do {                                  \
+        if (failures++ < 10)              \
+            printf ("FAIL " __VA_ARGS__); \
+    } while (0)
+
+// Сохранение, которое прерывается: параметры - глобальные из-за longjmp
+static uint8_t op_id[8];
+static uint16_t op_value[8];
+static uint8_t op_n;
+static uint8_t op_batch;
+static void (*op_run) (void);
+
+// op_run с отключением на операции cut (< 0 - без). 1 - питание пропало
+static int powered (long cut) {
+    flash_sim_power_cut (cut);
+    if (setjmp (flash_sim_cut))
+        return 1;
+    op_run();
+    flash_sim_power_cut (-1);
+    return 0;
+}
+
+// Отключение в каждом четвёртом: через раз на одной из первых 4 операций
+// (обычное сохранение), через раз - до CUT_MAX (уплотнение, перенос).
+// Номер за концом сохранения - отключения не будет
+static long random_cut (void) {
+    if (flash_sim_rand() % 4)
+        return -1;
+    return (long)(flash_sim_rand() % ((flash_sim_rand() & 1) ? 4 : CUT_MAX));
+}
+
+// Модель: последнее сохранённое значение каждого параметра
+static uint16_t model[NID];
+static uint8_t has[NID];
+
+// Чтение после сохранения (cut - оно было прервано). read - прочитать параметр
+static void check (int n, int cut, uint8_t (*read) (uint8_t id, uint16_t *value)) {
+    uint8_t only_old = 0, only_new = 0;  // Есть id только со старым / только с новым
+
+    for (uint8_t id = 0; id < NID; id++) {
+        uint16_t v = 0;
+        uint8_t found = read (id, &v);
+        uint8_t in = 0;
+        uint16_t nv = 0;
+
+        for (uint8_t i = 0; i < op_n; i++) {
+            if (op_id[i] == id) {
+                in = 1;
+                nv = op_value[i];  // Повтор id в пакете - последнее значение
+            }
+        }
+
+        uint8_t is_old = has[id] ? (found && v == model[id]) : !found;
+        uint8_t is_new = in && found && v == nv;
+
+        if (!in && !is_old)
+            FAIL ("save %d: untouched id %u reads %u (%s), was %u\n", n, id, v, found ? "found" : "missing", model[id]);
+        else if (in && !is_new && (!cut || !is_old))
+            FAIL ("save %d%s: id %u reads %u (%s), old %u, new %u\n", n, cut ? " (cut)" : "", id, v, found ? "found" : "missing", model[id], nv);
+
+        if (in) {
+            only_old |= is_old && !is_new;
+            only_new |= is_new && !is_old;
+        }
+        if (found) {
+            model[id] = v;
+            has[id] = 1;
+        }
+    }
+
+    // Пакет применяется целиком
+    if (op_batch && only_old && only_new)
+        FAIL ("save %d%s: batch of %u partly applied\n", n, cut ? " (cut)" : "", op_n);
+}
+
+/* ---------------- config.c ---------------- */
+
+static void cfg_boot (void) {
+    cfg_base = 0;
+    cfg_tail = 4;
+    cfg_gen = 0;
+    cfg_batch_n = 0;
+    Cfg_Init();
+}
+
+static void cfg_save (void) {
+    if (!op_batch) {
+        Cfg_Write (op_id[0], op_value[0]);
+        return;
+    }
+    for (uint8_t i = 0; i < op_n; i++)
+        Cfg_Stage (op_id[i], op_value[i]);
+    Cfg_Flush();
+}
+
+// Перезагрузка после отключения: она сама прерывается в каждой третьей
+static void reboot (void (*boot) (void)) {
+    op_run = boot;
+    if (flash_sim_rand() % 3 == 0)
+        powered ((long)(flash_sim_rand() % CUT_MAX));
+    boot();
+}
+
+static const struct {
+    uint8_t id;
+    uint16_t value;
+} legacy[] = {{0, 50}, {2, 10}, {5, 0}, {9, 1}, {11, 0x7FFF}};
+
+static void legacy_image (void) {
+    flash_sim_erase_all();
+    for (uint8_t i = 0; i < sizeof legacy / sizeof legacy[0]; i++) {
+        *(volatile uint16_t *)(CFG_START + legacy[i].id * CFG_PAGE) = legacy[i].value;
+        *(volatile uint16_t *)(CFG_START + legacy[i].id * CFG_PAGE + 2) = legacy[i].value;
+    }
+}
+
+static void test_import (void) {
+    int runs = 0, cuts = 0;
+
+    legacy_image();
+    cfg_boot();
+    uint32_t ops = flash_sim_ops;
+
+    for (uint32_t n = 0; n < ops; n++) {
+        for (int r = 0; r < 8; r++, runs++) {
+            legacy_image();
+            op_run = cfg_boot;
+            if (powered (n)) {
+                cuts++;
+                op_run = cfg_boot;
+                powered ((long)(flash_sim_rand() % ops));
+                cfg_boot();
+            }
+
+            for (uint8_t id = 0; id < NID; id++) {
+                uint16_t v, expect = 0;
+                uint8_t legacy_id = 0;
+                for (uint8_t i = 0; i < sizeof legacy / sizeof legacy[0]; i++) {
+                    if (legacy[i].id == id) {
+                        legacy_id = 1;
+                        expect = legacy[i].value;
+                    }
+                }
+                uint8_t found = Cfg_Read (id, &v);
+                if (found != legacy_id || (found && v != expect))
+                    FAIL ("import cut at op %u: id %u reads %u (%s)\n", (unsigned)n, id, v, found ? "found" : "missing");
+            }
+        }
+    }
+    printf ("config import: %u flash ops, %d runs, %d cut, failures %d\n", (unsigned)ops, runs, cuts, failures);
+}
+
+static void test_config (void) {
+    int cuts = 0, batch_cuts = 0, before = failures;
+
+    flash_sim_erase_all();
+    cfg_boot();
+    memset (has, 0, sizeof has);
+
+    for (int n = 1; n <= SAVES; n++) {
+        op_batch = flash_sim_rand() % 3 == 0;
+        op_n = op_batch ? 2 + flash_sim_rand() % 6 : 1;
+        for (uint8_t i = 0; i < op_n; i++) {
+            op_id[i] = flash_sim_rand() % NID;
+            op_value[i] = (uint16_t)flash_sim_rand();
+        }
+
+        op_run = cfg_save;
+        int cut = powered (random_cut());
+        if (cut) {
+            cuts++;
+            batch_cuts += op_batch;
+            reboot (cfg_boot);
+        } else if (n % 97 == 0) {
+            cfg_boot();
+        }
+        check (n, cut, Cfg_Read);
+    }
+
+    printf ("config journal: %d saves, %d cut (%d in a batch), failures %d\n", SAVES, cuts, batch_cuts, failures - before);
+    flash_sim_report ("config journal", CFG_START, CFG_START + 2 * CFG_HALF);
+}
+
+/* ---------------- EEPROM.c ---------------- */
+
+static EEPROM_HandleTypeDef ee;
+
+static void ee_boot (void) {
+    EEPROM_HandleTypeDef fresh = EEPROM_HANDLE_INIT (EE_PAGE0, EE_PAGE1, 1024);
+    ee = fresh;
+    EEPROM_Init (&ee);
+}
+
+static void ee_save (void) {
+    EEPROM_Write (&ee, op_id[0], op_value[0]);
+}
+
+static uint8_t ee_read (uint8_t id, uint16_t *value) {
+    return EEPROM_Read (&ee, id, value) == EEPROM_OK;
+}
+
+static void test_eeprom (void) {
+    int cuts = 0, before = failures;
+
+    flash_sim_erase_all();
+    ee_boot();
+    memset (has, 0, sizeof has);
+    op_batch = 0;
+    op_n = 1;
+
+    for (int n = 1; n <= SAVES; n++) {
+        op_id[0] = flash_sim_rand() % NID;
+        op_value[0] = (uint16_t)flash_sim_rand();
+
+        op_run = ee_save;
+        int cut = powered (random_cut());
+        if (cut) {
+            cuts++;
+            reboot (ee_boot);
+            if (ee.Status != EEPROM_OK)
+                FAIL ("save %d (cut): EEPROM_Init status %u\n", n, ee.Status);
+        } else if (n % 97 == 0) {
+            ee_boot();
+        }
+        check (n, cut, ee_read);
+    }
+
+    printf ("EEPROM: %d saves, %d cut, failures %d\n", SAVES, cuts, failures - before);
+    flash_sim_report ("EEPROM", EE_PAGE0, EE_PAGE1 + 1024);
+}
+
+int main (void) {
+    if (!flash_sim_map()) {
+        printf ("FAIL: cannot map flash window at 0x%08X\n", (unsigned)FLASH_SIM_BASE);
+        return 1;
+    }
+
+    test_import();
+    test_config();
+    test_eeprom();
+
+    printf ("power_test: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
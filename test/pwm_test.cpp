@@ -0,0 +1,240 @@
+/*
+ * PwmT::apply на хосте: порядок записи в регистры TIM1 и отсутствие
+ * "смешанного" периода (новый PSC со старым CCR и т.п.).
+ *
+ * Модель таймера (mock_tim.h): после каждой записи в регистр может прийти
+ * событие обновления. Если UDIS = 0, предзагрузка PSC/ATRLR/CH1CVR/CH2CVR
+ * переносится в рабочие регистры - снимок запоминается. Все снимки за
+ * операцию должны совпадать со старыми или с новыми значениями целиком.
+ *
+ * Арифметика без умножения: pwmTimingMax (PSC/ARR и частота), округление
+ * setDutyQ16/setDutyPermille, среднее сигма-дельты setDutyFine за N вызовов.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock_tim.h"
+#include "pwm.hpp"
+
+RCC_TypeDef mock_rcc;
+
+struct Snap {
+    uint16_t psc, arr;
+    uint32_t ccr2, ccr1;
+
+    bool operator== (const Snap &o) const {
+        return psc == o.psc && arr == o.arr && ccr2 == o.ccr2 && ccr1 == o.ccr1;
+    }
+};
+
+struct Write {
+    size_t off;
+    uint32_t value;
+};
+
+static Write mock_log[64];
+static int mock_n = 0;
+static Snap seen[64];
+static int seen_n = 0;
+static int failures = 0;
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+#define OFF(reg) offsetof (TIM_TypeDef, reg)
+
+static Snap preload (void) {
+    return Snap {TIM1->PSC.v, TIM1->ATRLR.v, TIM1->CH2CVR.v, TIM1->CH1CVR.v};
+}
+
+// Событие обновления таймера между записями
+static void mock_event (void) {
+    if ((TIM1->CTLR1.v & TIM_CEN) && !(TIM1->CTLR1.v & TIM_UDIS) && seen_n < 64)
+        seen[seen_n++] = preload();
+}
+
+void mock_write (const volatile void *reg, uint32_t value) {
+    uintptr_t a = (uintptr_t)reg;
+    if (a < TIM1_BASE || a >= TIM1_BASE + sizeof (TIM_TypeDef))
+        return;
+    if (mock_n < 64)
+        mock_log[mock_n++] = Write {a - TIM1_BASE, value};
+    mock_event();
+}
+
+static void start (void) {
+    mock_n = 0;
+    seen_n = 0;
+}
+
+// Все переносы за операцию - старый или новый набор целиком
+static int mixed (const Snap &before, const Snap &after) {
+    int bad = 0;
+    for (int i = 0; i < seen_n; i++)
+        if (!(seen[i] == before) && !(seen[i] == after))
+            bad++;
+    return bad;
+}
+
+static constexpr PwmTiming PWM_50 = pwmTiming (50);
+static constexpr PwmTiming PWM_5K = pwmTiming (5000);
+
+static void test_apply_order (Pwm &pwm) {
+    pwm.apply (PWM_50, 30);
+    Snap before = preload();
+
+    start();
+    pwm.apply (PWM_5K, 40);
+    Snap after = preload();
+
+    // UDIS = 1, затем PSC, ATRLR, CCR канала и канала запуска АЦП, затем UDIS = 0
+    CHECK (mock_n == 6);
+    CHECK (mock_log[0].off == OFF (CTLR1) && (mock_log[0].value & TIM_UDIS));
+    CHECK (mock_log[1].off == OFF (PSC) && mock_log[1].value == PWM_5K.psc);
+    CHECK (mock_log[2].off == OFF (ATRLR) && mock_log[2].value == PWM_5K.arr - 1u);
+    CHECK (mock_log[3].off == OFF (CH2CVR) && mock_log[3].value == 40);
+    CHECK (mock_log[4].off == OFF (CH1CVR) && mock_log[4].value == 20);
+    CHECK (mock_log[5].off == OFF (CTLR1) && !(mock_log[5].value & TIM_UDIS));
+
+    CHECK (!(before == after));
+    CHECK (mixed (before, after) == 0);
+    CHECK (seen_n > 0 && seen[seen_n - 1] == after);  // После UDIS = 0 - новый набор
+}
+
+// setFrequencyWithPeriod: lock, внутри setPeriod со своим lock/unlock
+static void test_nested_locks (Pwm &pwm) {
+    Snap before = preload();
+
+    start();
+    pwm.setFrequencyWithPeriod (1000, 200, 8000000);
+    Snap after = preload();
+
+    int ctlr = 0;
+    for (int i = 0; i < mock_n; i++)
+        if (mock_log[i].off == OFF (CTLR1))
+            ctlr++;
+
+    // Вложенный lock/unlock в регистр не пишет: UDIS ставится первой
+    // записью и снимается последней, после PSC
+    CHECK (ctlr == 2);
+    CHECK (mock_log[0].off == OFF (CTLR1) && (mock_log[0].value & TIM_UDIS));
+    CHECK (mock_log[mock_n - 1].off == OFF (CTLR1) && !(mock_log[mock_n - 1].value & TIM_UDIS));
+    CHECK (mock_log[mock_n - 2].off == OFF (PSC));
+    CHECK (after.arr == 199 && after.psc == 39);
+    CHECK (mixed (before, after) == 0);
+
+    // Счётчик вложенности вернулся в 0: следующий apply снова ставит UDIS
+    start();
+    pwm.apply (PWM_5K, 10);
+    CHECK (mock_log[0].off == OFF (CTLR1) && (mock_log[0].value & TIM_UDIS));
+    CHECK (!(TIM1->CTLR1.v & TIM_UDIS));
+}
+
+// Контроль модели: раздельные setPrescaler + setDutyPercent дают смешанный период
+static void test_model_detects_glitch (Pwm &pwm) {
+    pwm.apply (PWM_5K, 40);
+    Snap before = preload();
+
+    start();
+    pwm.setPrescaler (PWM_50.psc);
+    pwm.setDutyPercent (80);
+    Snap after = preload();
+
+    CHECK (mixed (before, after) > 0);
+}
+
+// PSC/ARR с максимальным ARR и получившаяся частота (8 МГц)
+static void test_timing_max (void) {
+    static const struct {
+        uint32_t hz;
+        uint16_t psc, arr;
+    } cases[] = {{50, 2, 53333}, {1000, 0, 8000}, {5000, 0, 1600}};
+
+    for (const auto &c : cases) {
+        PwmTiming t = pwmTimingMax (c.hz);
+        CHECK (t.psc == c.psc && t.arr == c.arr);
+        CHECK (t.k == pwmDutyK (c.arr));
+
+        double f = 8000000.0 / ((t.psc + 1.0) * t.arr);
+        CHECK (f > c.hz * 0.9999 && f < c.hz * 1.0001);
+    }
+}
+
+static constexpr PwmTiming PWM_5K_MAX = pwmTimingMax (5000);  // ARR 1600
+
+// Q16 и промилле -> CCR без дробной части (dither = 0): 0, середина, 100%
+static void test_duty_rounding (Pwm &pwm) {
+    pwm.apply (PWM_5K_MAX, 0);
+    pwm.dither = 0;
+
+    pwm.setDutyQ16 (0);
+    CHECK (TIM1->CH2CVR.v == 0);
+    pwm.setDutyQ16 (32768);
+    CHECK (TIM1->CH2CVR.v == 800);
+    pwm.setDutyQ16 (65536);
+    CHECK (TIM1->CH2CVR.v == 1600);
+    pwm.setDutyQ16 (70000);  // Больше 100% - ограничение
+    CHECK (TIM1->CH2CVR.v == 1600);
+
+    pwm.setDutyPermille (0);
+    CHECK (TIM1->CH2CVR.v == 0);
+    pwm.setDutyPermille (500);
+    CHECK (TIM1->CH2CVR.v == 800);
+    CHECK (TIM1->CH1CVR.v == 400);  // Запуск АЦП - середина импульса
+    pwm.setDutyPermille (1000);
+    CHECK (TIM1->CH2CVR.v == 1600);
+    pwm.setDutyPermille (1200);
+    CHECK (TIM1->CH2CVR.v == 1600);
+}
+
+// Сигма-дельта: среднее CCR за N вызовов = CCR в Q16 с точностью 1 / N тика
+static void test_dither_average (Pwm &pwm) {
+    static const uint32_t fine[] = {
+        (800UL << 16) | 0x4000,  // 800.25
+        (532UL << 16) | 53248,   // 532.8125 (33.3% при ARR 1600)
+        (10UL << 16) | 1,        // Почти целое
+    };
+    const int N = 4096;
+
+    pwm.apply (PWM_5K_MAX, 0);
+    pwm.dither = 1;
+    for (uint32_t c : fine) {
+        uint32_t sum = 0;
+        for (int i = 0; i < N; i++) {
+            pwm.setDutyFine (c);
+            uint32_t ccr = TIM1->CH2CVR.v;
+            CHECK (ccr == (c >> 16) || ccr == (c >> 16) + 1);
+            sum += ccr;
+        }
+        double avg = (double)sum / N;
+        double want = c / 65536.0;
+        CHECK (avg > want - 1.0 / N && avg < want + 1.0 / N);
+    }
+    pwm.dither = 0;
+}
+
+int main (void) {
+    if (!mock_map()) {
+        printf ("FAIL: cannot map peripheral window at 0x%08X\n", (unsigned)APB2PERIPH_BASE);
+        return 1;
+    }
+
+    Pwm pwm;
+    pwm.init (100, 7, 0);
+
+    test_apply_order (pwm);
+    test_nested_locks (pwm);
+    test_model_detects_glitch (pwm);
+    test_timing_max();
+    test_duty_rounding (pwm);
+    test_dither_average (pwm);
+
+    printf ("pwm_test: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
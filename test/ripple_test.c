@@ -0,0 +1,80 @@
+/*
+ * ripple.c на хосте: синтетический ток (постоянная составляющая +
+ * синус RIPPLE_PER_REV раз на оборот + шум) подаётся отсчётами 5 кГц
+ * через подменённые Current_Next/Current_Last, Ripple_Tick - раз в 1 мс.
+ * Оценка должна укладываться в +-5% (и шаг окна) от 500 до RIPPLE_RPM_MAX.
+ * Второй прогон - отсчёты 1 кГц (ШИМ старта без буста): предел fs / 5
+ * в пять раз ниже, до него оценка так же точна. Поэтому в RUNNING ШИМ -
+ * только 5 кГц.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <debug.h>
+
+#define FS_HZ     5000  // MOTOR_RUN_HZ
+#define DC        300
+#define AMP       6.0
+#define NOISE_LSB 1  // Равномерный шум +-1 LSB
+
+static double phase, step;
+static uint8_t pending;
+static uint8_t per_ms;  // Отсчётов за тик Ripple_Tick
+static uint32_t rnd = 12345;
+
+uint16_t Current_Last (void) {
+    return DC;
+}
+
+uint8_t Current_Next (uint16_t *sample) {
+    if (!pending)
+        return 0;
+    pending--;
+
+    rnd = rnd * 1103515245u + 12345u;
+    int noise = (int)((rnd >> 16) % (2 * NOISE_LSB + 1)) - NOISE_LSB;
+
+    *sample = (uint16_t)lround (DC + AMP * sin (phase) + noise);
+    phase += step;
+    return 1;
+}
+
+static uint16_t measure (uint16_t rpm, uint16_t fs) {
+    phase = 0.3;
+    per_ms = fs / 1000;
+    step = 2 * M_PI * (rpm * (double)RIPPLE_PER_REV / 60.0) / fs;
+    pending = 0;
+    Ripple_Reset();
+
+    // Два окна на установление, результат - третье
+    for (int ms = 0; ms < 300; ms++) {
+        pending = per_ms;
+        Ripple_Tick();
+    }
+    return Ripple_GetRpm();
+}
+
+// Ошибок в диапазоне 500..max об/мин при частоте отсчётов fs
+static int sweep (uint16_t fs, uint16_t max) {
+    int failures = 0;
+
+    for (uint16_t rpm = 500; rpm <= max; rpm += 250) {
+        uint16_t got = measure (rpm, fs);
+        int err = (int)got - rpm;
+        int tol = rpm / 20 + 100;  // 5% + шаг окна (100 об/мин)
+        if (err < -tol || err > tol) {
+            printf ("FAIL fs %u Hz, rpm %u: estimate %u\n", fs, rpm, got);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main (void) {
+    int failures = sweep (FS_HZ, RIPPLE_RPM_MAX);
+    failures += sweep (1000, RIPPLE_RPM_MAX / (FS_HZ / 1000));
+
+    printf ("ripple_test: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}